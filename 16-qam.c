@@ -13,6 +13,8 @@
 
 #include <immintrin.h> // AVX
 
+#include "qam-llr.h"
+
 // #define debug_sse
 // #define debug_avx
 #define debug_sse_llr
@@ -21,6 +23,14 @@
 /// @brief Utility function for display sse, avx-2, and avx512 data types
 void PrintIntrinsics(char *s, char *dtype, int num, void *x);
 
+/// @brief Codeblock-ready callback of the slot demo, prints the codeblock and checks its order
+static void SlotReady(void *arg, uint32_t cb, const int16_t *llr, uint32_t nb_llr)
+{
+  uint32_t *next = (uint32_t *)arg;
+  printf("codeblock %u ready: %u LLRs from %d\n", cb, nb_llr, llr[0]);
+  *next += (cb == *next);
+}
+
 int main()
 {
   clock_t start, end;
@@ -244,6 +254,274 @@ int main()
 
   printf("Success = %d, Error = %d\n", s, e);
 
+  /// ------------------------------- Scalar reference -------------------------------
+  printf("=========================== Reference ==========================\n");
+  int16_t llr_ref[64];
+  int16_t llr16sse[64], llrdense[64];
+  memcpy(llr16sse, llr32_sse, sizeof(llr16sse));
+  memcpy(llrdense, llr32_avx, sizeof(llrdense));
+  qam16_llr_ref(rxFcomp, dlchmag, 16, llr_ref);
+
+  s = 0, e = 0;
+  for (size_t i = 0; i < 64; i++)
+  {
+    if (llr16sse[i] == llr_ref[i] && llrdense[i] == llr_ref[i])
+      s++;
+    else
+    {
+      printf("Error: llr_sse[%zu] = %d, llr_avx[%zu] = %d, reference = %d\n", i, llr16sse[i], i, llrdense[i], llr_ref[i]);
+      e++;
+    }
+  }
+
+  printf("Reference: Success = %d, Error = %d\n", s, e);
+
+  /// ------------------------------- Sparse (DMRS/PTRS) -------------------------------
+  printf("============================ Sparse ============================\n");
+  // Uncompacted grid of 27 REs holding the 16 data REs of rxFcomp; bit k of re_mask is set for data REs
+  const int16_t *dlchmagdense[] = {dlchmag};
+  int16_t rxFgrid[64] __attribute__((aligned(32))), dlchmaggrid[1][64] __attribute__((aligned(32)));
+  const int16_t *dlchmagsparse[1];
+  uint8_t re_mask[4] = {0xaa, 0xff, 0x0a, 0x05};
+  int32_t re_idx[16];
+  int16_t llr_mask_sse[64], llr_mask_avx[64], llr_idx_avx[64];
+
+  for (size_t k = 0, r = 0; k < 27; k++)
+  {
+    int data = (re_mask[k >> 3] >> (k & 7)) & 1;
+    rxFgrid[2 * k] = data ? rxFcomp[2 * r] : 1000; // DMRS REs are not part of the output
+    rxFgrid[2 * k + 1] = data ? rxFcomp[2 * r + 1] : -1000;
+    for (size_t l = 0; l < 1; l++)
+    {
+      dlchmaggrid[l][2 * k] = data ? dlchmagdense[l][2 * r] : 0;
+      dlchmaggrid[l][2 * k + 1] = data ? dlchmagdense[l][2 * r + 1] : 0;
+    }
+    if (data)
+      re_idx[r++] = k;
+  }
+  for (size_t l = 0; l < 1; l++)
+    dlchmagsparse[l] = dlchmaggrid[l];
+
+  qam_llr_mask_sse(4, rxFgrid, dlchmagsparse, re_mask, 27, llr_mask_sse);
+  qam_llr_mask_avx(4, rxFgrid, dlchmagsparse, re_mask, 27, llr_mask_avx);
+  qam_llr_idx_avx(4, rxFgrid, dlchmagsparse, re_idx, 16, llr_idx_avx);
+
+  s = 0, e = 0;
+  for (size_t i = 0; i < 64; i++)
+  {
+    if (llr_mask_sse[i] == llrdense[i] && llr_mask_avx[i] == llrdense[i] && llr_idx_avx[i] == llrdense[i])
+      s++;
+    else
+    {
+      printf("Error: llr_avx[%zu] = %d, mask sse/avx = (%d, %d), idx avx = %d\n", i, llrdense[i],
+             llr_mask_sse[i], llr_mask_avx[i], llr_idx_avx[i]);
+      e++;
+    }
+  }
+
+  printf("Sparse: Success = %d, Error = %d\n", s, e);
+
+  /// ------------------------------- Hard decisions -------------------------------
+  printf("========================= Hard decision ========================\n");
+  int16_t llr_hard_sse[64];
+  uint8_t hard_sse[8], hard_avx[8];
+
+  qam_llr_hard_sse(4, rxFcomp, dlchmagdense, 16, llr_hard_sse, hard_sse);
+  qam_llr_hard_avx(4, rxFcomp, dlchmagdense, 16, NULL, hard_avx); // hard decisions only
+
+  s = 0, e = 0;
+  for (size_t i = 0; i < 64; i++)
+  {
+    int bit = llrdense[i] < 0;
+    if (llr_hard_sse[i] == llrdense[i] && ((hard_sse[i >> 3] >> (i & 7)) & 1) == bit &&
+        ((hard_avx[i >> 3] >> (i & 7)) & 1) == bit)
+      s++;
+    else
+    {
+      printf("Error: llr_avx[%zu] = %d, hard sse/avx = (%d, %d)\n", i, llrdense[i],
+             (hard_sse[i >> 3] >> (i & 7)) & 1, (hard_avx[i >> 3] >> (i & 7)) & 1);
+      e++;
+    }
+  }
+
+  printf("Hard decision: Success = %d, Error = %d\n", s, e);
+
+  /// ------------------------------ Per-PRB statistics ------------------------------
+  printf("========================== Statistics ==========================\n");
+  int16_t llr_stats_sse[48], llr_stats_avx[48];
+  qam_llr_prb_stats_t stats_sse, stats_avx, stats = {0};
+  uint32_t sum_abs[4] = {0};
+
+  qam_llr_stats_sse(4, rxFcomp, dlchmagdense, 1, llr_stats_sse, &stats_sse);
+  qam_llr_stats_avx(4, rxFcomp, dlchmagdense, 1, llr_stats_avx, &stats_avx);
+
+  // Same statistics from the dense LLRs of the first PRB
+  for (size_t i = 0; i < 48; i++)
+  {
+    int16_t h = dlchmagdense[0][2 * (i / 4) + (i & 1)] >> 1;
+    stats.nb_sat += (i % 4 >= 2) && (llrdense[i] == INT16_MAX || llrdense[i] == INT16_MIN);
+    sum_abs[i % 4] += (llrdense[i] < 0) ? -llrdense[i] : llrdense[i];
+    if (i % 4 >= 2)
+    {
+      int32_t d = ((llrdense[i] < 0) ? -llrdense[i] : llrdense[i]) - h;
+      stats.dist2 += d * d;
+      stats.ref2 += h * h;
+    }
+  }
+  for (size_t k = 0; k < 4; k++)
+    stats.mean_abs[k] = sum_abs[k] / 12;
+
+  s = 0, e = 0;
+  for (size_t i = 0; i < 48; i++)
+    (llr_stats_sse[i] == llrdense[i] && llr_stats_avx[i] == llrdense[i]) ? s++ : e++;
+  for (size_t k = 0; k < 4; k++)
+    (stats_sse.mean_abs[k] == stats.mean_abs[k] && stats_avx.mean_abs[k] == stats.mean_abs[k]) ? s++ : e++;
+  (stats_sse.nb_sat == stats.nb_sat && stats_avx.nb_sat == stats.nb_sat) ? s++ : e++;
+  (stats_sse.dist2 == stats.dist2 && stats_avx.dist2 == stats.dist2) ? s++ : e++;
+  (stats_sse.ref2 == stats.ref2 && stats_avx.ref2 == stats.ref2) ? s++ : e++;
+
+  printf("PRB 0: saturated = %u, evm proxy = %llu / %llu, mean |llr| = [", stats_avx.nb_sat,
+         (unsigned long long)stats_avx.dist2, (unsigned long long)stats_avx.ref2);
+  for (size_t k = 0; k < 4; k++)
+    printf(k ? ", %u" : "%u", stats_avx.mean_abs[k]);
+  printf("]\n");
+  printf("Statistics: Success = %d, Error = %d\n", s, e);
+
+  /// ------------------------------- Mapping profiles -------------------------------
+  printf("=========================== Profiles ===========================\n");
+  const qam_llr_profile_t *profiles[] = {&qam_profile_nr, &qam_profile_lte, &qam_profile_wifi};
+  int16_t llr_profile_ref[64], llr_profile_sse[64], llr_profile_avx[64];
+
+  s = 0, e = 0;
+  for (size_t k = 0; k < 3; k++)
+  {
+    qam_llr_profile_ref(profiles[k], 4, rxFcomp, dlchmagdense, 16, llr_profile_ref);
+    qam_llr_profile_sse(profiles[k], 4, rxFcomp, dlchmagdense, 16, llr_profile_sse);
+    qam_llr_profile_avx(profiles[k], 4, rxFcomp, dlchmagdense, 16, llr_profile_avx);
+    printf("%4s: llr of symbol (%d, %d) = [", profiles[k]->name, rxFcomp[0], rxFcomp[1]);
+    for (size_t j = 0; j < 4; j++)
+      printf(j ? ", %d" : "%d", llr_profile_avx[j]);
+    printf("]\n");
+    for (size_t i = 0; i < 64; i++)
+      (llr_profile_sse[i] == llr_profile_ref[i] && llr_profile_avx[i] == llr_profile_ref[i]) ? s++ : e++;
+  }
+
+  printf("Profiles: Success = %d, Error = %d\n", s, e);
+
+  /// ----------------------------------- Log-MAP -----------------------------------
+  printf("=========================== Log-MAP ===========================\n");
+  qam_logmap_t lm;
+  int16_t llr_logmap_ref[64], llr_logmap_sse[64], llr_logmap_avx[64];
+
+  qam_logmap_init(&lm, 0.05f);
+  qam_llr_logmap_ref(&lm, 4, rxFcomp, dlchmagdense, 16, llr_logmap_ref);
+  qam_llr_logmap_sse(&lm, 4, rxFcomp, dlchmagdense, 16, llr_logmap_sse);
+  qam_llr_logmap_avx(&lm, 4, rxFcomp, dlchmagdense, 16, llr_logmap_avx);
+  printf("max-log = [");
+  for (size_t j = 0; j < 4; j++)
+    printf(j ? ", %d" : "%d", llrdense[j]);
+  printf("], log-MAP = [");
+  for (size_t j = 0; j < 4; j++)
+    printf(j ? ", %d" : "%d", llr_logmap_avx[j]);
+  printf("]\n");
+
+  s = 0, e = 0;
+  for (size_t i = 0; i < 64; i++)
+    (llr_logmap_sse[i] == llr_logmap_ref[i] && llr_logmap_avx[i] == llr_logmap_ref[i]) ? s++ : e++;
+
+  printf("Log-MAP: Success = %d, Error = %d\n", s, e);
+
+  /// -------------------------------- Multi-UE batch --------------------------------
+  printf("=========================== Batch ===========================\n");
+  static qam_llr_batch_t batch;
+  const uint32_t ue_nb_re[] = {3, 6, 7};
+  qam_llr_ue_t ue[3];
+  int16_t llr_batch_sse[64], llr_batch_avx[64];
+
+  for (uint32_t u = 0, re = 0; u < 3; re += ue_nb_re[u++])
+  {
+    ue[u].rxF = &rxFcomp[2 * re];
+    for (int l = 0; l < QAM_NB_CHMAG(4); l++)
+      ue[u].chmag[l] = &dlchmagdense[l][2 * re];
+    ue[u].nb_re = ue_nb_re[u];
+    ue[u].llr = &llr_batch_sse[4 * re];
+  }
+  qam_llr_batch_init(&batch, 4, ue, 3);
+  qam_llr_batch_sse(&batch);
+  for (uint32_t u = 0, re = 0; u < 3; re += ue_nb_re[u++])
+    batch.ue[u].llr = &llr_batch_avx[4 * re];
+  qam_llr_batch_avx(&batch);
+  printf("%u UEs of 3, 6 and 7 REs in %u vectors\n", batch.nb_ue, batch.nb_vec);
+
+  s = 0, e = 0;
+  for (size_t i = 0; i < 64; i++)
+    (llr_batch_sse[i] == llrdense[i] && llr_batch_avx[i] == llrdense[i]) ? s++ : e++;
+
+  printf("Batch: Success = %d, Error = %d\n", s, e);
+
+  /// ----------------------------- Symbol-granular slot -----------------------------
+  printf("============================ Slot ============================\n");
+  // Two symbols of 9 and 7 data REs in 3 codeblocks; symbol 0 arrives as two PRB-like ranges, back first
+  static qam_llr_slot_t slot;
+  const uint32_t symb_re[] = {9, 7};
+  const int16_t *c[3];
+  int16_t llr_slot[64];
+  uint32_t next_cb = 0;
+  int nb_ready[3];
+
+  qam_llr_slot_init(&slot, 4, symb_re, 2, 3, llr_slot, SlotReady, &next_cb);
+  for (int l = 0; l < QAM_NB_CHMAG(4); l++)
+    c[l] = &dlchmagdense[l][2 * 5];
+  nb_ready[0] = qam_llr_slot_avx(&slot, 0, 5, &rxFcomp[2 * 5], c, 4);
+  nb_ready[1] = qam_llr_slot_sse(&slot, 0, 0, rxFcomp, dlchmagdense, 5);
+  for (int l = 0; l < QAM_NB_CHMAG(4); l++)
+    c[l] = &dlchmagdense[l][2 * 9];
+  nb_ready[2] = qam_llr_slot_avx(&slot, 1, 0, &rxFcomp[2 * 9], c, 7);
+  printf("codeblocks ready after each range: %d, %d, %d\n", nb_ready[0], nb_ready[1], nb_ready[2]);
+
+  s = 0, e = 0;
+  for (size_t i = 0; i < 64; i++)
+    (llr_slot[i] == llrdense[i]) ? s++ : e++;
+  (nb_ready[0] == 0 && nb_ready[1] == 1 && nb_ready[2] == 2 && next_cb == 3) ? s++ : e++;
+
+  printf("Slot: Success = %d, Error = %d\n", s, e);
+
+  /// ---------------------------------- Int8 input ----------------------------------
+  printf("============================ Int8 ============================\n");
+  // The symbols and magnitudes above fit in 8 bits as they are (shift 0)
+  int8_t rxF8[32], dlchmag8[32], llr8_sse[64], llr8_avx[64];
+
+  qam_pack8_avx(rxFcomp, 0, 32, rxF8);
+  qam_pack8_avx(dlchmag, 0, 32, dlchmag8);
+  qam16_llr8_sse(rxF8, dlchmag8, 16, llr8_sse);
+  qam16_llr8_avx(rxF8, dlchmag8, 16, llr8_avx);
+
+  s = 0, e = 0;
+  for (size_t i = 0; i < 64; i++)
+    (llr8_sse[i] == llrdense[i] && llr8_avx[i] == llrdense[i]) ? s++ : e++;
+
+  printf("Int8: Success = %d, Error = %d\n", s, e);
+
+  // Clipped samples at shift 2: the int8 LLRs must keep the sign of the int16 ones
+  int16_t big[32], bigmag[32], llr16_big[64];
+  const int16_t *bigmag_p[1] = {bigmag};
+  for (size_t i = 0; i < 32; i++)
+  {
+    big[i] = (int16_t)((i & 1) ? 800 - 50 * (int)i : -800 + 50 * (int)i);
+    bigmag[i] = 256;
+  }
+  qam_llr_avx(4, big, bigmag_p, 16, llr16_big);
+  qam_pack8_avx(big, 2, 32, rxF8);
+  qam_pack8_avx(bigmag, 2, 32, dlchmag8);
+  qam16_llr8_sse(rxF8, dlchmag8, 16, llr8_sse);
+  qam16_llr8_avx(rxF8, dlchmag8, 16, llr8_avx);
+
+  s = 0, e = 0;
+  for (size_t i = 0; i < 64; i++)
+    ((llr8_sse[i] < 0) == (llr16_big[i] < 0) && (llr8_avx[i] < 0) == (llr16_big[i] < 0)) ? s++ : e++;
+
+  printf("Int8 clipping: Success = %d, Error = %d\n", s, e);
+
   return 0;
 }
 
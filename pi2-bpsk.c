@@ -0,0 +1,90 @@
+/// @brief Computes Log-Likelihood Ratio (LLR) for pi/2-BPSK with the phase de-rotation fused in
+///
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <tmmintrin.h> // SSSE3
+#include <emmintrin.h> // SSE2
+#include <smmintrin.h> // SSE4.1
+
+#include <immintrin.h> // AVX
+
+#include "qam-llr.h"
+
+int main()
+{
+  clock_t start, end;
+  double sse_cpu_time, avx_cpu_time;
+  // Transmitted bits, symbol k rotated by j^(k mod 2)
+  const uint8_t bits[16] = {1, 0, 0, 1, 1, 1, 0, 0, 1, 0, 1, 1, 0, 1, 0, 0};
+  // Compensated received symbol
+  int16_t rxFcomp[] __attribute__((aligned(32))) = {-50, -39, -40, 37, 44, 52, 48, -37,
+                                                    -39, -55, 52, -57, 48, 41, -40, 40,
+                                                    -51, -35, -42, 50, -40, -42, 45, -37,
+                                                    37, 40, 53, -53, 49, 45, -34, 33};
+
+  // llr, one per symbol
+  int16_t llr_sse[16] = {[0 ... 15] = 0}, // for sse
+      llr_avx[16] = {[0 ... 15] = 0},     // for avx
+      llr_ref[16];
+
+  start = clock();
+  /// ------------------------------------- SSE -------------------------------------
+  printf("============================ SSE ===============================\n");
+  pi2bpsk_llr_sse(rxFcomp, 0, 16, llr_sse);
+  end = clock();
+  sse_cpu_time = ((double)(end - start)) / CLOCKS_PER_SEC;
+
+  start = clock();
+  /// ------------------------------------- AVX -------------------------------------
+  printf("============================ AVX ===============================\n");
+  pi2bpsk_llr_avx(rxFcomp, 0, 16, llr_avx);
+  end = clock();
+  avx_cpu_time = ((double)(end - start)) / CLOCKS_PER_SEC;
+  printf("CPU time duration for SSE = %E, and AVX256 = %E\n", sse_cpu_time, avx_cpu_time);
+
+  for (size_t i = 0; i < 16; i++)
+    printf("llr of symbol %zu (%d, %d) = %d\n", i, rxFcomp[2 * i], rxFcomp[2 * i + 1], llr_avx[i]);
+
+  int s = 0, e = 0;
+  for (size_t i = 0; i < 16; i++)
+    (llr_sse[i] == llr_avx[i]) ? s++ : e++;
+
+  printf("Success = %d, Error = %d\n", s, e);
+
+  /// ------------------------------- Scalar reference -------------------------------
+  printf("=========================== Reference ==========================\n");
+  pi2bpsk_llr_ref(rxFcomp, 0, 16, llr_ref);
+
+  s = 0, e = 0;
+  for (size_t i = 0; i < 16; i++)
+    (llr_avx[i] == llr_ref[i]) ? s++ : e++;
+
+  printf("Reference: Success = %d, Error = %d\n", s, e);
+
+  /// ----------------------------------- Bits -----------------------------------
+  printf("============================= Bits =============================\n");
+  s = 0, e = 0;
+  for (size_t i = 0; i < 16; i++)
+    ((llr_avx[i] < 0) == bits[i]) ? s++ : e++;
+
+  printf("Bits: Success = %d, Error = %d\n", s, e);
+
+  /// ------------------------------ Odd first symbol ------------------------------
+  printf("======================= Odd first symbol =======================\n");
+  // A call that starts mid-allocation at the odd symbol 9 keeps the rotation of the whole allocation
+  pi2bpsk_llr_ref(&rxFcomp[18], 9, 7, llr_ref);
+  pi2bpsk_llr_sse(&rxFcomp[18], 9, 7, llr_sse);
+  pi2bpsk_llr_avx(&rxFcomp[18], 9, 7, llr_avx);
+
+  s = 0, e = 0;
+  for (size_t i = 0; i < 7; i++)
+    (llr_sse[i] == llr_ref[i] && llr_avx[i] == llr_ref[i] && (llr_ref[i] < 0) == bits[9 + i]) ? s++ : e++;
+
+  printf("Odd first symbol: Success = %d, Error = %d\n", s, e);
+
+  return 0;
+}
@@ -0,0 +1,200 @@
+/// @brief O-RAN BFP packet files: generator, and fused-kernel check and timing against the two-pass path
+///
+/// Usage:
+///   qam-bfp -g <file> [qm] [nb_prb] [seed]   write a packet file of noisy Gray-mapped PRBs (default 6 273 1)
+///   qam-bfp <file>...                        check the fused kernels and time them
+///
+/// A packet file is a 12-byte header followed by the payload, all little-endian:
+///   char magic[4] "QBFP", uint16 version, uint8 qm, uint8 reserved, uint32 nb_prb
+///   uint8 prb[nb_prb][28]                       udCompParam + 24 9-bit mantissas
+///   int16 chmag[QAM_NB_CHMAG(qm)][2 * 12 * nb_prb]  channel magnitude levels
+///
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "qam-llr.h"
+#include "qam-bfp.h"
+
+#define QAM_BFP_MAGIC "QBFP"
+#define QAM_BFP_VERSION 1
+
+typedef struct
+{
+  char magic[4];
+  uint16_t version;
+  uint8_t qm;
+  uint8_t reserved;
+  uint32_t nb_prb;
+} qam_bfp_hdr_t;
+
+static uint64_t state = 0x243f6a8885a308d3ULL;
+
+static uint64_t rand64(void)
+{
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  return state * 0x2545f4914f6cdd1dULL;
+}
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/// @brief Writes nb_prb PRBs of a Gray-mapped constellation with per-RE gain and noise, compressed
+static int generate(const char *path, int qm, uint32_t nb_prb)
+{
+  int nb_chmag = QAM_NB_CHMAG(qm), m = 1 << (qm / 2);
+  size_t n = 2 * QAM_NB_RE_PRB * (size_t)nb_prb;
+  qam_bfp_hdr_t hdr = {QAM_BFP_MAGIC, QAM_BFP_VERSION, (uint8_t)qm, 0, nb_prb};
+  int16_t *rxF = malloc(n * sizeof(int16_t)), *chmag = malloc(3 * n * sizeof(int16_t));
+  uint8_t *prb = malloc((size_t)nb_prb * QAM_BFP9_PRB_BYTES);
+  FILE *f = fopen(path, "wb");
+  int ok = rxF && chmag && prb && f;
+
+  for (size_t i = 0; ok && i < n; i += 2)
+  {
+    // amplitude of the smallest point varies per PRB so that the exponents differ
+    int32_t a = 32 << ((i / (2 * QAM_NB_RE_PRB)) % 5);
+    int32_t g = 128 + (int32_t)(rand64() % 256); // Q8 channel gain
+    for (int c = 0; c < 2; c++)
+    {
+      int32_t x = ((2 * (int32_t)(rand64() % m) - (m - 1)) * a * g) >> 8;
+      x += (int32_t)(rand64() % (2 * a / 3 + 1)) - a / 3;
+      rxF[i + c] = (int16_t)((x > INT16_MAX) ? INT16_MAX : (x < INT16_MIN) ? INT16_MIN : x);
+      for (int l = 0; l < nb_chmag; l++)
+        chmag[l * n + i + c] = (int16_t)(((a << (nb_chmag - l)) * g) >> 8);
+    }
+  }
+  if (ok)
+  {
+    qam_bfp9_compress(rxF, nb_prb, prb);
+    ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1 && fwrite(prb, QAM_BFP9_PRB_BYTES, nb_prb, f) == nb_prb &&
+         fwrite(chmag, sizeof(int16_t), nb_chmag * n, f) == nb_chmag * n;
+  }
+  if (f && fclose(f))
+    ok = 0;
+  free(rxF);
+  free(chmag);
+  free(prb);
+  if (!ok)
+    printf("Error: cannot write %s\n", path);
+  else
+    printf("%s: qm = %d, nb_prb = %u, %zu bytes of IQ instead of %zu\n", path, qm, nb_prb,
+           (size_t)nb_prb * QAM_BFP9_PRB_BYTES, n * sizeof(int16_t));
+  return ok ? 0 : -1;
+}
+
+/// @brief Checks the fused kernels of one packet file and prints their throughput next to the two-pass path
+static int run(const char *path, int *s, int *e)
+{
+  qam_bfp_hdr_t hdr;
+  FILE *f = fopen(path, "rb");
+
+  if (!f || fread(&hdr, sizeof(hdr), 1, f) != 1 || memcmp(hdr.magic, QAM_BFP_MAGIC, 4) ||
+      hdr.version != QAM_BFP_VERSION || (hdr.qm != 4 && hdr.qm != 6 && hdr.qm != 8))
+  {
+    printf("Error: %s is not a packet file\n", path);
+    if (f)
+      fclose(f);
+    return -1;
+  }
+
+  int qm = hdr.qm, nb_chmag = QAM_NB_CHMAG(qm);
+  uint32_t nb_prb = hdr.nb_prb, nb_re = QAM_NB_RE_PRB * nb_prb;
+  size_t n = 2 * (size_t)nb_re;
+  uint8_t *prb = malloc((size_t)nb_prb * QAM_BFP9_PRB_BYTES);
+  int16_t *chmag[3] = {0}, *rxF = malloc(n * sizeof(int16_t));
+  int16_t *llr_ref = malloc(n * qm / 2 * sizeof(int16_t)), *llr = malloc(n * qm / 2 * sizeof(int16_t));
+  int ok = prb && rxF && llr_ref && llr && fread(prb, QAM_BFP9_PRB_BYTES, nb_prb, f) == nb_prb;
+
+  for (int l = 0; ok && l < nb_chmag; l++)
+    ok = (chmag[l] = malloc(n * sizeof(int16_t))) && fread(chmag[l], sizeof(int16_t), n, f) == n;
+  fclose(f);
+  if (!ok)
+  {
+    printf("Error: %s is truncated\n", path);
+    return -1;
+  }
+  const int16_t *const *c = (const int16_t *const *)chmag;
+
+  qam_llr_bfp9_ref(qm, prb, c, nb_prb, llr_ref);
+  static const struct
+  {
+    const char *name;
+    void (*fn)(int, const uint8_t *, const int16_t *const *, uint32_t, int16_t *);
+  } fused[] = {{"fused sse", qam_llr_bfp9_sse}, {"fused avx", qam_llr_bfp9_avx}};
+
+  for (size_t k = 0; k < 2; k++)
+  {
+    memset(llr, 0, n * qm / 2 * sizeof(int16_t));
+    fused[k].fn(qm, prb, c, nb_prb, llr);
+    int err = memcmp(llr, llr_ref, n * qm / 2 * sizeof(int16_t)) != 0;
+    err ? (*e)++ : (*s)++;
+
+    double t = now();
+    long reps = 0;
+    do
+      fused[k].fn(qm, prb, c, nb_prb, llr), reps++;
+    while (now() - t < 0.05);
+    printf("%s: %-9s %8.1f MRE/s%s\n", path, fused[k].name, nb_re * reps / (now() - t) * 1e-6, err ? "  MISMATCH" : "");
+  }
+
+  // Two passes: SIMD decompression into an int16 buffer, then the AVX2 kernel
+  double t = now();
+  long reps = 0;
+  do
+  {
+    qam_bfp9_decompress_sse(prb, nb_prb, rxF);
+    qam_llr_avx(qm, rxF, c, nb_re, llr);
+    reps++;
+  } while (now() - t < 0.05);
+  printf("%s: %-9s %8.1f MRE/s\n", path, "two-pass", nb_re * reps / (now() - t) * 1e-6);
+  memcmp(llr, llr_ref, n * qm / 2 * sizeof(int16_t)) ? (*e)++ : (*s)++;
+
+  free(prb);
+  free(rxF);
+  free(llr_ref);
+  free(llr);
+  for (int l = 0; l < 3; l++)
+    free(chmag[l]);
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  int s = 0, e = 0;
+
+  if (argc > 2 && !strcmp(argv[1], "-g"))
+  {
+    int qm = (argc > 3) ? atoi(argv[3]) : 6;
+    long nb_prb = (argc > 4) ? atol(argv[4]) : 273;
+    if (argc > 5)
+      state = strtoull(argv[5], NULL, 0) | 1;
+    if ((qm != 4 && qm != 6 && qm != 8) || nb_prb < 1)
+    {
+      fprintf(stderr, "qm must be 4, 6 or 8 and nb_prb positive\n");
+      return 1;
+    }
+    return generate(argv[2], qm, (uint32_t)nb_prb) ? 1 : 0;
+  }
+  if (argc < 2)
+  {
+    fprintf(stderr, "usage: %s -g <file> [qm] [nb_prb] [seed]\n       %s <file>...\n", argv[0], argv[0]);
+    return 1;
+  }
+
+  for (int i = 1; i < argc; i++)
+    if (run(argv[i], &s, &e))
+      e++;
+
+  printf("Success = %d, Error = %d\n", s, e);
+  return e != 0;
+}
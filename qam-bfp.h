@@ -0,0 +1,160 @@
+/// @brief O-RAN 7.2 block floating point (9-bit mantissa) IQ fused into the LLR kernels
+///
+/// A compressed PRB is 28 bytes: udCompParam (exponent in the low 4 bits) followed by the 24
+/// mantissas I0 Q0 I1 Q1 ... I11 Q11, 9 bits each, packed MSB first. The sample is
+/// mantissa << exponent.
+///
+/// The fused kernels expand 8 mantissas (4 REs, 9 bytes) per pshufb: lane k gathers the two
+/// bytes holding mantissa k, a multiply by 2^k left-aligns it, and an arithmetic shift by 7
+/// sign-extends it. The PRB then goes through the usual abs/subs recursion, so the int16 rxF
+/// buffer is never written and the input traffic drops from 48 to 28 bytes per PRB.
+///
+
+#ifndef QAM_BFP_H
+#define QAM_BFP_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "qam-llr.h"
+
+#define QAM_BFP9_PRB_BYTES 28
+
+/// @brief Scalar decompression of nb_prb PRBs into int16 rxF
+static inline void qam_bfp9_decompress(const uint8_t *prb, uint32_t nb_prb, int16_t *rxF)
+{
+  for (uint32_t p = 0; p < nb_prb; p++, prb += QAM_BFP9_PRB_BYTES)
+  {
+    int e = prb[0] & 15;
+    for (int k = 0; k < 2 * QAM_NB_RE_PRB; k++)
+    {
+      int bit = 9 * k;
+      uint32_t w = ((uint32_t)prb[1 + bit / 8] << 8) | prb[2 + bit / 8];
+      int32_t m = (w >> (7 - bit % 8)) & 0x1ff;
+      m -= (m & 0x100) << 1;
+      rxF[2 * QAM_NB_RE_PRB * p + k] = (int16_t)(uint16_t)((uint32_t)m << e);
+    }
+  }
+}
+
+/// @brief Scalar compression of nb_prb PRBs, smallest exponent that fits every sample of the PRB
+static inline void qam_bfp9_compress(const int16_t *rxF, uint32_t nb_prb, uint8_t *prb)
+{
+  for (uint32_t p = 0; p < nb_prb; p++, prb += QAM_BFP9_PRB_BYTES)
+  {
+    const int16_t *x = &rxF[2 * QAM_NB_RE_PRB * p];
+    int e = 0;
+    for (int k = 0; k < 2 * QAM_NB_RE_PRB; k++)
+      while ((x[k] >> e) > 255 || (x[k] >> e) < -256)
+        e++;
+    memset(prb, 0, QAM_BFP9_PRB_BYTES);
+    prb[0] = (uint8_t)e;
+    for (int k = 0; k < 2 * QAM_NB_RE_PRB; k++)
+    {
+      int bit = 9 * k;
+      uint32_t w = ((uint32_t)(x[k] >> e) & 0x1ff) << (7 - bit % 8);
+      prb[1 + bit / 8] |= (uint8_t)(w >> 8);
+      prb[2 + bit / 8] |= (uint8_t)w;
+    }
+  }
+}
+
+/// @brief Scalar reference of qam_llr_bfp9_sse/avx: decompression followed by qam_llr_ref()
+static inline void qam_llr_bfp9_ref(int qm, const uint8_t *prb, const int16_t *const *chmag, uint32_t nb_prb,
+                                    int16_t *llr)
+{
+  int16_t rxF[2 * QAM_NB_RE_PRB];
+  const int16_t *c[3];
+
+  for (uint32_t p = 0; p < nb_prb; p++)
+  {
+    qam_bfp9_decompress(&prb[p * QAM_BFP9_PRB_BYTES], 1, rxF);
+    for (int l = 0; l < QAM_NB_CHMAG(qm); l++)
+      c[l] = &chmag[l][2 * QAM_NB_RE_PRB * p];
+    qam_llr_ref(qm, rxF, c, QAM_NB_RE_PRB, &llr[QAM_NB_RE_PRB * qm * p]);
+  }
+}
+
+/// @brief Expands the 8 mantissas whose first bytes are selected by shuf, then scales them by 2^e
+static inline __m128i qam_bfp9_expand_sse(__m128i bytes, __m128i shuf, __m128i e)
+{
+  const __m128i align = _mm_setr_epi16(1, 2, 4, 8, 16, 32, 64, 128);
+  __m128i w = _mm_mullo_epi16(_mm_shuffle_epi8(bytes, shuf), align);
+  return _mm_sll_epi16(_mm_srai_epi16(w, 7), e);
+}
+
+/// @brief Decompression of nb_prb PRBs into int16 rxF using SSE, for callers that need the samples
+static inline void qam_bfp9_decompress_sse(const uint8_t *prb, uint32_t nb_prb, int16_t *rxF)
+{
+  const __m128i shuf01 = _mm_setr_epi8(1, 0, 2, 1, 3, 2, 4, 3, 5, 4, 6, 5, 7, 6, 8, 7);
+  const __m128i shuf2 = _mm_setr_epi8(8, 7, 9, 8, 10, 9, 11, 10, 12, 11, 13, 12, 14, 13, 15, 14);
+
+  for (uint32_t p = 0; p < nb_prb; p++, prb += QAM_BFP9_PRB_BYTES, rxF += 2 * QAM_NB_RE_PRB)
+  {
+    const uint8_t *m = prb + 1;
+    __m128i e = _mm_cvtsi32_si128(prb[0] & 15);
+
+    _mm_storeu_si128((__m128i *)rxF, qam_bfp9_expand_sse(_mm_loadu_si128((const __m128i *)m), shuf01, e));
+    _mm_storeu_si128((__m128i *)(rxF + 8), qam_bfp9_expand_sse(_mm_loadu_si128((const __m128i *)(m + 9)), shuf01, e));
+    _mm_storeu_si128((__m128i *)(rxF + 16), qam_bfp9_expand_sse(_mm_loadu_si128((const __m128i *)(m + 11)), shuf2, e));
+  }
+}
+
+/// @brief LLRs of nb_prb BFP-compressed PRBs using SSE, 3 groups of 4 REs per PRB
+static inline void qam_llr_bfp9_sse(int qm, const uint8_t *prb, const int16_t *const *chmag, uint32_t nb_prb,
+                                    int16_t *llr)
+{
+  // big-endian byte pairs (k, k + 1); the last group is loaded 7 bytes early to stay inside the PRB
+  const __m128i shuf01 = _mm_setr_epi8(1, 0, 2, 1, 3, 2, 4, 3, 5, 4, 6, 5, 7, 6, 8, 7);
+  const __m128i shuf2 = _mm_setr_epi8(8, 7, 9, 8, 10, 9, 11, 10, 12, 11, 13, 12, 14, 13, 15, 14);
+  __m128i y[4];
+
+  for (uint32_t p = 0; p < nb_prb; p++, prb += QAM_BFP9_PRB_BYTES)
+  {
+    const uint8_t *m = prb + 1;
+    __m128i e = _mm_cvtsi32_si128(prb[0] & 15);
+    uint32_t re = QAM_NB_RE_PRB * p;
+
+    y[0] = qam_bfp9_expand_sse(_mm_loadu_si128((const __m128i *)m), shuf01, e);
+    qam_llr_core_sse(qm, y, chmag, re);
+    qam_llr_store_sse(qm, y, &llr[re * qm]);
+    y[0] = qam_bfp9_expand_sse(_mm_loadu_si128((const __m128i *)(m + 9)), shuf01, e);
+    qam_llr_core_sse(qm, y, chmag, re + 4);
+    qam_llr_store_sse(qm, y, &llr[(re + 4) * qm]);
+    y[0] = qam_bfp9_expand_sse(_mm_loadu_si128((const __m128i *)(m + 11)), shuf2, e);
+    qam_llr_core_sse(qm, y, chmag, re + 8);
+    qam_llr_store_sse(qm, y, &llr[(re + 8) * qm]);
+  }
+}
+
+/// @brief LLRs of nb_prb BFP-compressed PRBs using AVX2: REs 0-7 in one vector, 8-11 in an SSE one
+static inline void qam_llr_bfp9_avx(int qm, const uint8_t *prb, const int16_t *const *chmag, uint32_t nb_prb,
+                                    int16_t *llr)
+{
+  const __m128i shuf01 = _mm_setr_epi8(1, 0, 2, 1, 3, 2, 4, 3, 5, 4, 6, 5, 7, 6, 8, 7);
+  const __m128i shuf2 = _mm_setr_epi8(8, 7, 9, 8, 10, 9, 11, 10, 12, 11, 13, 12, 14, 13, 15, 14);
+  const __m256i shuf = _mm256_broadcastsi128_si256(shuf01);
+  const __m256i align = _mm256_setr_epi16(1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128);
+  __m256i y[4];
+  __m128i x[4];
+
+  for (uint32_t p = 0; p < nb_prb; p++, prb += QAM_BFP9_PRB_BYTES)
+  {
+    const uint8_t *m = prb + 1;
+    __m128i e = _mm_cvtsi32_si128(prb[0] & 15);
+    uint32_t re = QAM_NB_RE_PRB * p;
+
+    // groups 0 and 1 side by side, one per 128-bit lane
+    __m256i b = _mm256_loadu2_m128i((const __m128i *)(m + 9), (const __m128i *)m);
+    __m256i w = _mm256_mullo_epi16(_mm256_shuffle_epi8(b, shuf), align);
+    y[0] = _mm256_sll_epi16(_mm256_srai_epi16(w, 7), e);
+    qam_llr_core_avx(qm, y, chmag, re);
+    qam_llr_store_avx(qm, y, &llr[re * qm]);
+
+    x[0] = qam_bfp9_expand_sse(_mm_loadu_si128((const __m128i *)(m + 11)), shuf2, e);
+    qam_llr_core_sse(qm, x, chmag, re + 8);
+    qam_llr_store_sse(qm, x, &llr[(re + 8) * qm]);
+  }
+}
+
+#endif
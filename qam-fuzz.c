@@ -0,0 +1,538 @@
+/// @brief Randomized differential test of the SSE/AVX LLR kernels against the scalar reference
+///
+/// Usage: qam-fuzz [iterations] [seed]
+/// Build with -DQAM_LIBFUZZER (and -fsanitize=fuzzer) to get a libFuzzer entry point instead of main().
+///
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "qam-llr.h"
+#include "qam-bfp.h"
+#include "qam-tune.h"
+
+#define MAX_RE 512
+#define CANARY ((int16_t)0x5a5a)
+
+static int16_t rxF_buf[2 * MAX_RE + 32] __attribute__((aligned(32)));
+static int16_t chmag_buf[3][2 * MAX_RE + 32] __attribute__((aligned(32)));
+static int16_t llr_ref[8 * MAX_RE], llr_out[8 * MAX_RE + 128] __attribute__((aligned(64)));
+static uint8_t hard_out[MAX_RE + 8];
+
+/// @brief Scalar reference of qam_llr_stats_sse/avx
+static void qam_llr_stats_ref(int qm, const int16_t *rxF, const int16_t *const *chmag, uint32_t nb_prb,
+                              qam_llr_prb_stats_t *stats)
+{
+  int16_t llr[QAM_NB_RE_PRB * 8];
+  const int16_t *c[3];
+
+  for (uint32_t p = 0; p < nb_prb; p++)
+  {
+    uint32_t sum_abs[8] = {0};
+    uint32_t re0 = p * QAM_NB_RE_PRB;
+
+    for (int l = 0; l < QAM_NB_CHMAG(qm); l++)
+      c[l] = &chmag[l][2 * re0];
+    qam_llr_ref(qm, &rxF[2 * re0], c, QAM_NB_RE_PRB, llr);
+
+    memset(&stats[p], 0, sizeof(stats[p]));
+    for (int j = 0; j < QAM_NB_RE_PRB * qm; j++)
+    {
+      int k = j % qm;
+      int16_t v = llr[j];
+      sum_abs[k] += (v == INT16_MIN) ? 32768 : (uint32_t)qam_abs16(v);
+      stats[p].nb_sat += (k >= 2) && (v == INT16_MAX || v == INT16_MIN);
+      if (k >= qm - 2)
+      {
+        int16_t h = c[QAM_NB_CHMAG(qm) - 1][2 * (j / qm) + (k & 1)] >> 1;
+        int32_t d = qam_abs16(qam_subs16(qam_abs16(v), h));
+        stats[p].dist2 += (uint64_t)((int64_t)d * d);
+        stats[p].ref2 += (uint64_t)((int64_t)h * h);
+      }
+    }
+    for (int k = 0; k < qm; k++)
+      stats[p].mean_abs[k] = sum_abs[k] / QAM_NB_RE_PRB;
+  }
+}
+
+/// @brief Compares n LLRs against the reference and checks the canary after them
+static int qam_fuzz_cmp(const char *name, int qm, uint32_t nb_re, const int16_t *out, const int16_t *ref, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    if (out[i] != ref[i])
+    {
+      printf("Error: %s qm = %d, nb_re = %u: llr[%u] = %d, reference = %d\n", name, qm, nb_re, i, out[i], ref[i]);
+      return 1;
+    }
+  for (uint32_t i = n; i < n + 64; i++)
+    if (out[i] != CANARY)
+    {
+      printf("Error: %s qm = %d, nb_re = %u: write past the end at llr[%u]\n", name, qm, nb_re, i);
+      return 1;
+    }
+  return 0;
+}
+
+/// @brief Compares n packed hard decisions against the signs of the reference LLRs
+static int qam_fuzz_cmp_hard(const char *name, int qm, uint32_t nb_re, const uint8_t *hard, const int16_t *ref, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    if (((hard[i >> 3] >> (i & 7)) & 1) != (ref[i] < 0))
+    {
+      printf("Error: %s qm = %d, nb_re = %u: hard bit %u = %d, reference llr = %d\n", name, qm, nb_re, i,
+             (hard[i >> 3] >> (i & 7)) & 1, ref[i]);
+      return 1;
+    }
+  return 0;
+}
+
+/// @brief Codeblock-ready callback of the slot check: in order, and every LLR already final
+typedef struct
+{
+  const qam_llr_slot_t *slot;
+  uint32_t next;
+  int err;
+} qam_fuzz_slot_t;
+
+static void qam_fuzz_slot_ready(void *arg, uint32_t cb, const int16_t *llr, uint32_t nb_llr)
+{
+  qam_fuzz_slot_t *f = (qam_fuzz_slot_t *)arg;
+  uint32_t first = f->slot->cb_llr[cb];
+
+  if (cb != f->next++ || llr != &llr_out[first] || nb_llr != f->slot->cb_llr[cb + 1] - first ||
+      memcmp(llr, &llr_ref[first], nb_llr * sizeof(int16_t)))
+    f->err++;
+}
+
+/// @brief Runs every SIMD backend on one input and checks it bit-exactly against the reference
+/// @return number of failed checks
+static int qam_fuzz_one(int qm, const int16_t *rxF, const int16_t *const *chmag, uint32_t nb_re,
+                        const uint8_t *re_mask, const int32_t *re_idx, uint32_t nb_idx)
+{
+  typedef void (*llr_fn)(int, const int16_t *, const int16_t *const *, uint32_t, int16_t *);
+  typedef void (*hard_fn)(int, const int16_t *, const int16_t *const *, uint32_t, int16_t *, uint8_t *);
+  typedef uint32_t (*mask_fn)(int, const int16_t *, const int16_t *const *, const uint8_t *, uint32_t, int16_t *);
+  typedef void (*stats_fn)(int, const int16_t *, const int16_t *const *, uint32_t, int16_t *, qam_llr_prb_stats_t *);
+  static const struct { const char *name; llr_fn fn; } llr_fns[] = {{"sse", qam_llr_sse}, {"avx", qam_llr_avx}};
+  static const struct { const char *name; llr_fn fn; } llr_variants[] = {
+    {"sse nt", qam_llr_sse_nt}, {"avx nt", qam_llr_avx_nt},
+#ifdef __AVX512BW__
+    {"avx512", qam_llr_avx512}, {"avx512 nt", qam_llr_avx512_nt},
+#endif
+  };
+  static const struct { const char *name; hard_fn fn; } hard_fns[] = {{"hard sse", qam_llr_hard_sse}, {"hard avx", qam_llr_hard_avx}};
+  static const struct { const char *name; mask_fn fn; } mask_fns[] = {{"mask sse", qam_llr_mask_sse}, {"mask avx", qam_llr_mask_avx}};
+  static const struct { const char *name; stats_fn fn; } stats_fns[] = {{"stats sse", qam_llr_stats_sse}, {"stats avx", qam_llr_stats_avx}};
+  static int16_t expect[8 * MAX_RE];
+  static qam_llr_prb_stats_t stats_ref[MAX_RE / QAM_NB_RE_PRB], stats_out[MAX_RE / QAM_NB_RE_PRB];
+  uint32_t n = nb_re * qm, nb_data = 0, nb_prb = nb_re / QAM_NB_RE_PRB;
+  int e = 0;
+
+  qam_llr_ref(qm, rxF, chmag, nb_re, llr_ref);
+
+  // the other kernel variants, on the aligned buffer and one RE off it
+  for (size_t k = 0; k < sizeof(llr_variants) / sizeof(llr_variants[0]); k++)
+    for (uint32_t off = 0; off <= (uint32_t)qm; off += qm)
+    {
+      for (size_t i = 0; i < n + 64 + off; i++)
+        llr_out[i] = CANARY;
+      llr_variants[k].fn(qm, rxF, chmag, nb_re, llr_out + off);
+      e += qam_fuzz_cmp(llr_variants[k].name, qm, nb_re, llr_out + off, llr_ref, n);
+    }
+
+  // tuned dispatch: every ISA the host has, both store modes, every chunk size
+  static qam_tune_t tune;
+  if (!tune.isa_mask)
+    tune.isa_mask = qam_tune_isa_mask();
+  for (int isa = 0; isa < QAM_TUNE_NB_ISA; isa++)
+    for (size_t ch = 0; (tune.isa_mask >> isa) & 1 && ch < sizeof(qam_tune_chunks) / sizeof(qam_tune_chunks[0]); ch++)
+    {
+      qam_tune_cfg_t *c = &tune.cfg[(qm - 4) / 2];
+      c->isa = (uint8_t)isa;
+      c->nt = ch & 1;
+      c->chunk_re = qam_tune_chunks[ch];
+      for (size_t i = 0; i < n + 64; i++)
+        llr_out[i] = CANARY;
+      qam_tune_llr(&tune, qm, rxF, chmag, nb_re, llr_out);
+      e += qam_fuzz_cmp("tuned", qm, nb_re, llr_out, llr_ref, n);
+    }
+
+  for (size_t k = 0; k < 2; k++)
+  {
+    for (size_t i = 0; i < n + 64; i++)
+      llr_out[i] = CANARY;
+    llr_fns[k].fn(qm, rxF, chmag, nb_re, llr_out);
+    e += qam_fuzz_cmp(llr_fns[k].name, qm, nb_re, llr_out, llr_ref, n);
+
+    for (size_t i = 0; i < n + 64; i++)
+      llr_out[i] = CANARY;
+    hard_fns[k].fn(qm, rxF, chmag, nb_re, (nb_re & 1) ? NULL : llr_out, hard_out);
+    if (!(nb_re & 1))
+      e += qam_fuzz_cmp(hard_fns[k].name, qm, nb_re, llr_out, llr_ref, n);
+    e += qam_fuzz_cmp_hard(hard_fns[k].name, qm, nb_re, hard_out, llr_ref, n);
+  }
+
+  // Sparse kernels: expected output is the reference of the data REs only
+  for (uint32_t i = 0; i < nb_re; i++)
+    if ((re_mask[i >> 3] >> (i & 7)) & 1)
+      memcpy(&expect[qm * nb_data++], &llr_ref[qm * i], qm * sizeof(int16_t));
+  for (size_t k = 0; k < 2; k++)
+  {
+    for (size_t i = 0; i < n + 64; i++)
+      llr_out[i] = CANARY;
+    if (mask_fns[k].fn(qm, rxF, chmag, re_mask, nb_re, llr_out) != nb_data)
+    {
+      printf("Error: %s qm = %d, nb_re = %u: wrong number of data REs\n", mask_fns[k].name, qm, nb_re);
+      e++;
+    }
+    e += qam_fuzz_cmp(mask_fns[k].name, qm, nb_re, llr_out, expect, nb_data * qm);
+  }
+
+  for (uint32_t i = 0; i < nb_idx; i++)
+    memcpy(&expect[qm * i], &llr_ref[qm * re_idx[i]], qm * sizeof(int16_t));
+  for (size_t i = 0; i < n + 64; i++)
+    llr_out[i] = CANARY;
+  qam_llr_idx_avx(qm, rxF, chmag, re_idx, nb_idx, llr_out);
+  e += qam_fuzz_cmp("idx avx", qm, nb_re, llr_out, expect, nb_idx * qm);
+
+  static const qam_llr_profile_t *profiles[] = {&qam_profile_nr, &qam_profile_lte, &qam_profile_wifi};
+  for (size_t k = 0; k < sizeof(profiles) / sizeof(profiles[0]); k++)
+  {
+    qam_llr_profile_ref(profiles[k], qm, rxF, chmag, nb_re, expect);
+    for (size_t i = 0; i < n + 64; i++)
+      llr_out[i] = CANARY;
+    qam_llr_profile_sse(profiles[k], qm, rxF, chmag, nb_re, llr_out);
+    e += qam_fuzz_cmp(profiles[k]->name, qm, nb_re, llr_out, expect, n);
+    for (size_t i = 0; i < n + 64; i++)
+      llr_out[i] = CANARY;
+    qam_llr_profile_avx(profiles[k], qm, rxF, chmag, nb_re, llr_out);
+    e += qam_fuzz_cmp(profiles[k]->name, qm, nb_re, llr_out, expect, n);
+  }
+
+  static const float llr_per_unit[] = {0.002f, 0.05f, 0.3f, 4.0f};
+  for (size_t k = 0; k < sizeof(llr_per_unit) / sizeof(llr_per_unit[0]); k++)
+  {
+    qam_logmap_t lm;
+    qam_logmap_init(&lm, llr_per_unit[k]);
+    qam_llr_logmap_ref(&lm, qm, rxF, chmag, nb_re, expect);
+    for (size_t i = 0; i < n + 64; i++)
+      llr_out[i] = CANARY;
+    qam_llr_logmap_sse(&lm, qm, rxF, chmag, nb_re, llr_out);
+    e += qam_fuzz_cmp("logmap sse", qm, nb_re, llr_out, expect, n);
+    for (size_t i = 0; i < n + 64; i++)
+      llr_out[i] = CANARY;
+    qam_llr_logmap_avx(&lm, qm, rxF, chmag, nb_re, llr_out);
+    e += qam_fuzz_cmp("logmap avx", qm, nb_re, llr_out, expect, n);
+  }
+
+  // Batch: the REs cut into small allocations whose sizes (0 to 48 REs) follow the mask bytes,
+  // the last UE takes whatever is left
+  static qam_llr_batch_t batch;
+  qam_llr_ue_t ue[MAX_RE / 8];
+  uint32_t nb_ue = 0;
+  for (uint32_t re = 0; re < nb_re; nb_ue++)
+  {
+    uint32_t size = (nb_ue == MAX_RE / 8 - 1) ? nb_re : re_mask[nb_ue] % 49;
+    ue[nb_ue].nb_re = (size < nb_re - re) ? size : nb_re - re;
+    ue[nb_ue].rxF = &rxF[2 * re];
+    for (int l = 0; l < QAM_NB_CHMAG(qm); l++)
+      ue[nb_ue].chmag[l] = &chmag[l][2 * re];
+    ue[nb_ue].llr = &llr_out[qm * re];
+    re += ue[nb_ue].nb_re;
+  }
+  if (qam_llr_batch_init(&batch, qm, ue, nb_ue))
+  {
+    printf("Error: batch qm = %d, nb_re = %u: descriptor table rejected\n", qm, nb_re);
+    e++;
+  }
+  for (size_t i = 0; i < n + 64; i++)
+    llr_out[i] = CANARY;
+  qam_llr_batch_sse(&batch);
+  e += qam_fuzz_cmp("batch sse", qm, nb_re, llr_out, llr_ref, n);
+  for (size_t i = 0; i < n + 64; i++)
+    llr_out[i] = CANARY;
+  qam_llr_batch_avx(&batch);
+  e += qam_fuzz_cmp("batch avx", qm, nb_re, llr_out, llr_ref, n);
+
+  // Slot: up to 14 symbols whose sizes follow the mask bytes, each demapped as two ranges,
+  // the back one first on odd symbols; every codeblock must be signalled once its LLRs are final
+  static qam_llr_slot_t slot;
+  uint32_t symb_re[QAM_SLOT_MAX_SYMB], symb_re0[QAM_SLOT_MAX_SYMB], nb_symb = 0;
+  for (uint32_t re = 0; re < nb_re; nb_symb++)
+  {
+    uint32_t size = (nb_symb == QAM_SLOT_MAX_SYMB - 1) ? nb_re : re_mask[nb_symb] % 97;
+    symb_re[nb_symb] = (size < nb_re - re) ? size : nb_re - re;
+    symb_re0[nb_symb] = re;
+    re += symb_re[nb_symb];
+  }
+  uint32_t nb_cb = nb_re ? 1 + re_mask[MAX_RE / 8 - 1] % ((nb_re < 20) ? nb_re : 20) : 1;
+  for (size_t k = 0; nb_re && k < 2; k++)
+  {
+    qam_fuzz_slot_t ctx = {&slot, 0, 0};
+    for (size_t i = 0; i < n + 64; i++)
+      llr_out[i] = CANARY;
+    if (qam_llr_slot_init(&slot, qm, symb_re, nb_symb, nb_cb, llr_out, qam_fuzz_slot_ready, &ctx))
+    {
+      printf("Error: slot qm = %d, nb_re = %u: layout rejected\n", qm, nb_re);
+      e++;
+      break;
+    }
+    for (uint32_t l = 0; l < nb_symb; l++)
+    {
+      uint32_t cut = symb_re[l] ? re_mask[l + 16] % (symb_re[l] + 1) : 0;
+      for (uint32_t h = 0; h < 2; h++)
+      {
+        uint32_t back = (h ^ l) & 1, re0 = back ? cut : 0, nb = back ? symb_re[l] - cut : cut;
+        const int16_t *c[3];
+        for (int j = 0; j < QAM_NB_CHMAG(qm); j++)
+          c[j] = &chmag[j][2 * (symb_re0[l] + re0)];
+        (k ? qam_llr_slot_avx : qam_llr_slot_sse)(&slot, l, re0, &rxF[2 * (symb_re0[l] + re0)], c, nb);
+      }
+    }
+    e += qam_fuzz_cmp(k ? "slot avx" : "slot sse", qm, nb_re, llr_out, llr_ref, n);
+    if (ctx.err || ctx.next != nb_cb)
+    {
+      printf("Error: slot %s qm = %d, nb_re = %u: %u of %u codeblocks signalled, %d out of order or early\n",
+             k ? "avx" : "sse", qm, nb_re, ctx.next, nb_cb, ctx.err);
+      e++;
+    }
+  }
+
+  // Int8 input: rxF and chmag brought to 8 bits by a shift that follows the mask, then the
+  // QPSK and 16-QAM kernels against their scalar references; the canary is the top byte of CANARY
+  static int8_t rxF8[2 * MAX_RE], chmag8[2 * MAX_RE], pack8[2 * MAX_RE + 64], llr8_ref[4 * MAX_RE], llr8[4 * MAX_RE + 64];
+  int shift = nb_re ? re_mask[0] % 9 : 0;
+  qam_pack8_ref(rxF, shift, 2 * nb_re, rxF8);
+  qam_pack8_ref(chmag[0], shift, 2 * nb_re, chmag8);
+  memset(pack8, 0x5a, sizeof(pack8));
+  qam_pack8_avx(rxF, shift, 2 * nb_re, pack8);
+  if (memcmp(pack8, rxF8, 2 * nb_re) || pack8[2 * nb_re] != 0x5a)
+  {
+    printf("Error: pack8 avx nb_re = %u, shift = %d differs\n", nb_re, shift);
+    e++;
+  }
+  for (int q = 2; q <= 4; q += 2)
+  {
+    (q == 2) ? qpsk_llr8_ref(rxF8, nb_re, llr8_ref) : qam16_llr8_ref(rxF8, chmag8, nb_re, llr8_ref);
+    for (size_t k = 0; k < 2; k++)
+    {
+      memset(llr8, 0x5a, sizeof(llr8));
+      if (q == 2)
+        (k ? qpsk_llr8_avx : qpsk_llr8_sse)(rxF8, nb_re, llr8);
+      else
+        (k ? qam16_llr8_avx : qam16_llr8_sse)(rxF8, chmag8, nb_re, llr8);
+      for (uint32_t i = 0; i < q * nb_re + 64; i++)
+        if ((i < q * nb_re) ? llr8[i] != llr8_ref[i] : llr8[i] != 0x5a)
+        {
+          printf("Error: %s8 %s qm = %d, nb_re = %u: llr[%u] = %d%s\n", (q == 2) ? "qpsk" : "qam16",
+                 k ? "avx" : "sse", q, nb_re, i, llr8[i], (i < q * nb_re) ? "" : ", written past the end");
+          e++;
+          break;
+        }
+    }
+  }
+
+  // Clipping must not flip a decision: wherever the exact 16-QAM LLR (the int16 one before its own
+  // INT16_MIN corner) is clear of the shift rounding, 2 << shift, the int8 one has its sign or is 0.
+  // I = -800, c = 256, shift 2 used to give +127 against -544.
+  qam16_llr8_avx(rxF8, chmag8, nb_re, llr8);
+  for (uint32_t i = 0; i < 4 * nb_re; i++)
+  {
+    uint32_t j = 2 * (i / 4) + (i & 1);
+    int32_t x = (i & 2) ? chmag[0][j] - abs(rxF[j]) : rxF[j];
+    if ((x >= (2 << shift) && llr8[i] < 0) || (x <= -(2 << shift) && llr8[i] > 0))
+    {
+      printf("Error: qam16 llr8 nb_re = %u, shift = %d: llr[%u] = %d, exact llr = %d\n", nb_re, shift, i, llr8[i], x);
+      e++;
+      break;
+    }
+  }
+
+  // QPSK and pi/2-BPSK only read rxF; both parities of the first symbol
+  qpsk_llr_ref(rxF, nb_re, expect);
+  for (size_t k = 0; k < 2; k++)
+  {
+    for (size_t i = 0; i < n + 64; i++)
+      llr_out[i] = CANARY;
+    (k ? qpsk_llr_avx : qpsk_llr_sse)(rxF, nb_re, llr_out);
+    e += qam_fuzz_cmp(k ? "qpsk avx" : "qpsk sse", 2, nb_re, llr_out, expect, 2 * nb_re);
+  }
+  for (uint32_t first = 0; first < 2; first++)
+  {
+    pi2bpsk_llr_ref(rxF, first, nb_re, expect);
+    for (size_t k = 0; k < 2; k++)
+    {
+      for (size_t i = 0; i < n + 64; i++)
+        llr_out[i] = CANARY;
+      (k ? pi2bpsk_llr_avx : pi2bpsk_llr_sse)(rxF, first, nb_re, llr_out);
+      e += qam_fuzz_cmp(k ? "pi/2-bpsk avx" : "pi/2-bpsk sse", 1, nb_re, llr_out, expect, nb_re);
+    }
+#ifdef __AVX512BW__
+    for (size_t i = 0; i < n + 64; i++)
+      llr_out[i] = CANARY;
+    pi2bpsk_llr_avx512(rxF, first, nb_re, llr_out);
+    e += qam_fuzz_cmp("pi/2-bpsk avx512", 1, nb_re, llr_out, expect, nb_re);
+#endif
+  }
+#ifdef __AVX512BW__
+  qpsk_llr_ref(rxF, nb_re, expect);
+  for (size_t i = 0; i < n + 64; i++)
+    llr_out[i] = CANARY;
+  qpsk_llr_avx512(rxF, nb_re, llr_out);
+  e += qam_fuzz_cmp("qpsk avx512", 2, nb_re, llr_out, expect, 2 * nb_re);
+#endif
+
+  // BFP: the fused kernels against decompression followed by the reference, on the compressed rxF
+  static uint8_t bfp[MAX_RE / QAM_NB_RE_PRB * QAM_BFP9_PRB_BYTES];
+  static int16_t rxF_bfp[2 * MAX_RE];
+  qam_bfp9_compress(rxF, nb_prb, bfp);
+  qam_llr_bfp9_ref(qm, bfp, chmag, nb_prb, expect);
+  qam_bfp9_decompress(bfp, nb_prb, rxF_bfp);
+  qam_bfp9_decompress_sse(bfp, nb_prb, (int16_t *)llr_out);
+  if (memcmp(llr_out, rxF_bfp, 2 * QAM_NB_RE_PRB * nb_prb * sizeof(int16_t)))
+  {
+    printf("Error: bfp decompress sse nb_prb = %u differs\n", nb_prb);
+    e++;
+  }
+  for (size_t k = 0; k < 2; k++)
+  {
+    for (size_t i = 0; i < n + 64; i++)
+      llr_out[i] = CANARY;
+    (k ? qam_llr_bfp9_avx : qam_llr_bfp9_sse)(qm, bfp, chmag, nb_prb, llr_out);
+    e += qam_fuzz_cmp(k ? "bfp avx" : "bfp sse", qm, nb_re, llr_out, expect, nb_prb * QAM_NB_RE_PRB * qm);
+  }
+
+  qam_llr_stats_ref(qm, rxF, chmag, nb_prb, stats_ref);
+  for (size_t k = 0; k < 2; k++)
+  {
+    for (size_t i = 0; i < n + 64; i++)
+      llr_out[i] = CANARY;
+    stats_fns[k].fn(qm, rxF, chmag, nb_prb, llr_out, stats_out);
+    e += qam_fuzz_cmp(stats_fns[k].name, qm, nb_re, llr_out, llr_ref, nb_prb * QAM_NB_RE_PRB * qm);
+    for (uint32_t p = 0; p < nb_prb; p++)
+      if (stats_out[p].nb_sat != stats_ref[p].nb_sat || stats_out[p].dist2 != stats_ref[p].dist2 ||
+          stats_out[p].ref2 != stats_ref[p].ref2 ||
+          memcmp(stats_out[p].mean_abs, stats_ref[p].mean_abs, qm * sizeof(stats_ref[p].mean_abs[0])))
+      {
+        printf("Error: %s qm = %d, nb_re = %u: statistics of PRB %u differ\n", stats_fns[k].name, qm, nb_re, p);
+        e++;
+        break;
+      }
+  }
+
+  return e;
+}
+
+#ifdef QAM_LIBFUZZER
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+  static uint8_t re_mask[MAX_RE / 8];
+  static int32_t re_idx[MAX_RE];
+  const int16_t *chmag[3];
+
+  if (size < 3)
+    return 0;
+
+  // data[0]: modulation order, data[1]: misalignment in int16, data[2]: RE mask pattern, then rxF and chmag
+  int qm = 4 + 2 * (data[0] % 3), off = data[1] & 15;
+  size_t nb_re = (size - 3) / (2 * sizeof(int16_t) * (1 + QAM_NB_CHMAG(qm)));
+  nb_re = nb_re > MAX_RE ? MAX_RE : nb_re;
+
+  int16_t *rxF = &rxF_buf[off];
+  memcpy(rxF, &data[3], 2 * nb_re * sizeof(int16_t));
+  for (int l = 0; l < QAM_NB_CHMAG(qm); l++)
+  {
+    chmag[l] = &chmag_buf[l][off];
+    memcpy(&chmag_buf[l][off], &data[3 + (l + 1) * 2 * nb_re * sizeof(int16_t)], 2 * nb_re * sizeof(int16_t));
+  }
+  for (size_t i = 0; i < MAX_RE / 8; i++)
+    re_mask[i] = data[2] ^ (uint8_t)(i * 0x3b);
+  for (size_t i = 0; i < nb_re; i++)
+    re_idx[i] = (int32_t)((nb_re - 1 - i) * (data[2] | 1) % nb_re);
+
+  if (qam_fuzz_one(qm, rxF, chmag, nb_re, re_mask, re_idx, nb_re))
+    abort();
+  return 0;
+}
+
+#else
+
+static uint64_t qam_fuzz_state = 0x9e3779b97f4a7c15ULL;
+
+/// @brief xorshift64* generator, reproducible from the seed given on the command line
+static uint64_t qam_fuzz_rand(void)
+{
+  qam_fuzz_state ^= qam_fuzz_state >> 12;
+  qam_fuzz_state ^= qam_fuzz_state << 25;
+  qam_fuzz_state ^= qam_fuzz_state >> 27;
+  return qam_fuzz_state * 0x2545f4914f6cdd1dULL;
+}
+
+/// @brief Random int16 drawn from the full range, small values or the saturation edge cases
+static int16_t qam_fuzz_value(int mode)
+{
+  static const int16_t edge[] = {INT16_MIN, INT16_MIN + 1, -16384, -1, 0, 1, 16383, INT16_MAX - 1, INT16_MAX};
+
+  switch (mode)
+  {
+  case 0:
+    return (int16_t)qam_fuzz_rand();
+  case 1:
+    return (int16_t)(qam_fuzz_rand() % 256) - 128;
+  default:
+    return edge[qam_fuzz_rand() % (sizeof(edge) / sizeof(edge[0]))];
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  long iterations = (argc > 1) ? atol(argv[1]) : 10000;
+  uint8_t re_mask[MAX_RE / 8];
+  int32_t re_idx[MAX_RE];
+  const int16_t *chmag[3];
+  int s = 0, e = 0;
+
+  if (argc > 2)
+    qam_fuzz_state = strtoull(argv[2], NULL, 0) | 1;
+
+  for (long it = 0; it < iterations; it++)
+  {
+    int qm = 4 + 2 * (qam_fuzz_rand() % 3);
+    int off = qam_fuzz_rand() % 16; // misalignment of every buffer, in int16
+    uint32_t nb_re = qam_fuzz_rand() % (MAX_RE + 1);
+    int rx_mode = qam_fuzz_rand() % 3, ch_mode = qam_fuzz_rand() % 3;
+    uint32_t nb_idx = nb_re ? qam_fuzz_rand() % (nb_re + 1) : 0;
+    int16_t *rxF = &rxF_buf[off];
+
+    for (uint32_t i = 0; i < 2 * nb_re; i++)
+      rxF[i] = qam_fuzz_value(rx_mode);
+    for (int l = 0; l < QAM_NB_CHMAG(qm); l++)
+    {
+      chmag[l] = &chmag_buf[l][off];
+      for (uint32_t i = 0; i < 2 * nb_re; i++)
+        chmag_buf[l][off + i] = qam_fuzz_value(ch_mode);
+    }
+    // DMRS-like masks, fully dense/empty bytes and random ones
+    for (size_t i = 0; i < MAX_RE / 8; i++)
+    {
+      static const uint8_t pattern[] = {0x00, 0xff, 0xaa, 0x55, 0xee, 0x77};
+      re_mask[i] = (qam_fuzz_rand() & 1) ? pattern[qam_fuzz_rand() % sizeof(pattern)] : (uint8_t)qam_fuzz_rand();
+    }
+    for (uint32_t i = 0; i < nb_idx; i++)
+      re_idx[i] = qam_fuzz_rand() % nb_re;
+
+    if (qam_fuzz_one(qm, rxF, chmag, nb_re, re_mask, re_idx, nb_idx))
+      e++;
+    else
+      s++;
+  }
+
+  printf("Success = %d, Error = %d\n", s, e);
+
+  return e != 0;
+}
+
+#endif
@@ -0,0 +1,470 @@
+/// @brief Golden-vector regression runner: validates and times every LLR kernel over a corpus
+///
+/// Usage:
+///   qam-golden -g <dir>                                   write the default corpus to <dir>
+///   qam-golden [-b baseline] [-u] [-t pct] [-m ms] vector...
+///     -b  baseline file of "<vector> <kernel> <MRE/s>" lines
+///     -u  write the measured throughput to the baseline file instead of checking it
+///     -t  tolerated throughput drop against the baseline in percent (default 10)
+///     -m  minimum measurement time per kernel and vector in ms (default 20)
+/// Exits with 1 when an LLR differs from the vector, a kernel is slower than the baseline allows or
+/// has no entry in it, or no vector is given.
+///
+/// The hard-decision kernels are also checked against the signs of the expected LLRs, and the
+/// masked kernels run with a fixed RE mask (qam_golden_mask()) against the expected LLRs of the
+/// REs it keeps.
+///
+/// Each vector's header is printed before its results, with the fixed-point scale its samples
+/// were generated at: the LLRs of corpora at different scales do not compare.
+///
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "qam-llr.h"
+#include "qam-vec.h"
+
+#define MAX_BASELINE 1024
+
+static uint8_t *hard_buf, *mask_buf;
+static qam_llr_prb_stats_t *stats_buf;
+
+/// @brief What a kernel output is compared with
+typedef enum
+{
+  CHECK_LLR,  // llr against the vector
+  CHECK_HARD, // llr against the vector, hard_buf against the signs of its LLRs
+  CHECK_MASK, // llr against the vector LLRs of the REs kept by mask_buf
+} check_t;
+
+static uint32_t run_sse(const qam_vec_t *v, int16_t *llr)
+{
+  qam_llr_sse(v->hdr.qm, v->rxF, (const int16_t *const *)v->chmag, v->hdr.nb_re, llr);
+  return v->hdr.nb_re;
+}
+
+static uint32_t run_avx(const qam_vec_t *v, int16_t *llr)
+{
+  qam_llr_avx(v->hdr.qm, v->rxF, (const int16_t *const *)v->chmag, v->hdr.nb_re, llr);
+  return v->hdr.nb_re;
+}
+
+static uint32_t run_hard_sse(const qam_vec_t *v, int16_t *llr)
+{
+  qam_llr_hard_sse(v->hdr.qm, v->rxF, (const int16_t *const *)v->chmag, v->hdr.nb_re, llr, hard_buf);
+  return v->hdr.nb_re;
+}
+
+static uint32_t run_hard_avx(const qam_vec_t *v, int16_t *llr)
+{
+  qam_llr_hard_avx(v->hdr.qm, v->rxF, (const int16_t *const *)v->chmag, v->hdr.nb_re, llr, hard_buf);
+  return v->hdr.nb_re;
+}
+
+static uint32_t run_mask_sse(const qam_vec_t *v, int16_t *llr)
+{
+  return qam_llr_mask_sse(v->hdr.qm, v->rxF, (const int16_t *const *)v->chmag, mask_buf, v->hdr.nb_re, llr);
+}
+
+static uint32_t run_mask_avx(const qam_vec_t *v, int16_t *llr)
+{
+  return qam_llr_mask_avx(v->hdr.qm, v->rxF, (const int16_t *const *)v->chmag, mask_buf, v->hdr.nb_re, llr);
+}
+
+static uint32_t run_stats_sse(const qam_vec_t *v, int16_t *llr)
+{
+  qam_llr_stats_sse(v->hdr.qm, v->rxF, (const int16_t *const *)v->chmag, v->hdr.nb_re / QAM_NB_RE_PRB, llr, stats_buf);
+  return v->hdr.nb_re / QAM_NB_RE_PRB * QAM_NB_RE_PRB;
+}
+
+static uint32_t run_stats_avx(const qam_vec_t *v, int16_t *llr)
+{
+  qam_llr_stats_avx(v->hdr.qm, v->rxF, (const int16_t *const *)v->chmag, v->hdr.nb_re / QAM_NB_RE_PRB, llr, stats_buf);
+  return v->hdr.nb_re / QAM_NB_RE_PRB * QAM_NB_RE_PRB;
+}
+
+/// @brief Kernels under test; run() returns the number of REs whose LLRs it wrote
+static const struct
+{
+  const char *name;
+  uint32_t (*run)(const qam_vec_t *v, int16_t *llr);
+  check_t check;
+} kernels[] = {
+    {"sse", run_sse, CHECK_LLR},
+    {"avx", run_avx, CHECK_LLR},
+    {"hard_sse", run_hard_sse, CHECK_HARD},
+    {"hard_avx", run_hard_avx, CHECK_HARD},
+    {"mask_sse", run_mask_sse, CHECK_MASK},
+    {"mask_avx", run_mask_avx, CHECK_MASK},
+    {"stats_sse", run_stats_sse, CHECK_LLR},
+    {"stats_avx", run_stats_avx, CHECK_LLR},
+};
+
+#define NB_KERNELS (sizeof(kernels) / sizeof(kernels[0]))
+
+static struct
+{
+  char vector[256];
+  char kernel[32];
+  double mres;
+} baseline[MAX_BASELINE];
+static int nb_baseline;
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/// @brief Best throughput in million REs per second over 5 runs of at least min_ms / 5 each
+static double qam_golden_time(size_t k, const qam_vec_t *v, int16_t *llr, double min_ms)
+{
+  long reps = 1;
+  double best = 0;
+
+  // Calibrate the repetition count so that one run lasts at least min_ms / 5
+  for (;;)
+  {
+    double t = now();
+    for (long r = 0; r < reps; r++)
+      kernels[k].run(v, llr);
+    t = now() - t;
+    if (t * 1e3 >= min_ms / 5 || reps >= (1L << 30))
+      break;
+    reps *= 2;
+  }
+  for (int run = 0; run < 5; run++)
+  {
+    double t = now();
+    for (long r = 0; r < reps; r++)
+      kernels[k].run(v, llr);
+    t = now() - t;
+    double mres = (double)v->hdr.nb_re * reps / t * 1e-6;
+    best = (mres > best) ? mres : best;
+  }
+  return best;
+}
+
+/// @brief Fixed RE mask of nb_re bits: whole bytes kept, dropped and DMRS-like combs, then a
+/// pseudo-random pattern, so that every SIMD block sees a different selection
+static void qam_golden_mask(uint8_t *mask, uint32_t nb_re)
+{
+  static const uint8_t pattern[] = {0xff, 0x00, 0x55, 0xaa, 0xf0, 0x0f};
+  uint32_t h = 0x9e3779b9;
+
+  for (uint32_t i = 0; i < nb_re / 8 + 1; i++)
+  {
+    h = h * 1664525 + 1013904223;
+    mask[i] = (i < 2 * sizeof(pattern)) ? pattern[i % sizeof(pattern)] : (uint8_t)(h >> 24);
+  }
+}
+
+/// @brief Compares one kernel output with the vector
+/// @return number of differing LLRs and hard bits, mismatching RE counts included
+static uint32_t qam_golden_check(size_t k, const qam_vec_t *v, uint32_t nb, const int16_t *llr)
+{
+  int qm = v->hdr.qm;
+  uint32_t bad = 0, n = 0;
+
+  switch (kernels[k].check)
+  {
+  case CHECK_MASK:
+    for (uint32_t re = 0; re < v->hdr.nb_re; re++)
+      if ((mask_buf[re >> 3] >> (re & 7)) & 1)
+      {
+        for (int b = 0; n < nb && b < qm; b++)
+          bad += llr[(size_t)n * qm + b] != v->llr[(size_t)re * qm + b];
+        n++;
+      }
+    return bad + (n != nb);
+  case CHECK_HARD:
+    for (uint32_t j = 0; j < nb * qm; j++)
+      bad += ((hard_buf[j >> 3] >> (j & 7)) & 1) != (v->llr[j] < 0);
+    // fall through
+  case CHECK_LLR:
+    for (uint32_t i = 0; i < nb * qm; i++)
+      bad += llr[i] != v->llr[i];
+    return bad;
+  }
+  return 0;
+}
+
+static const char *basename_of(const char *path)
+{
+  const char *b = strrchr(path, '/');
+  return b ? b + 1 : path;
+}
+
+static int qam_golden_load_baseline(const char *path)
+{
+  FILE *f = fopen(path, "r");
+  char line[512];
+
+  if (!f)
+    return -1;
+  while (fgets(line, sizeof(line), f) && nb_baseline < MAX_BASELINE)
+  {
+    if (line[0] == '#')
+      continue;
+    if (sscanf(line, "%255s %31s %lf", baseline[nb_baseline].vector, baseline[nb_baseline].kernel,
+               &baseline[nb_baseline].mres) == 3)
+      nb_baseline++;
+  }
+  fclose(f);
+  return 0;
+}
+
+static double qam_golden_baseline(const char *vector, const char *kernel)
+{
+  for (int i = 0; i < nb_baseline; i++)
+    if (!strcmp(baseline[i].vector, vector) && !strcmp(baseline[i].kernel, kernel))
+      return baseline[i].mres;
+  return 0;
+}
+
+/// ------------------------------- Corpus generation -------------------------------
+
+static uint64_t qam_golden_state = 0x243f6a8885a308d3ULL;
+
+/// @brief xorshift64* generator, the corpus must not depend on the C library
+static uint64_t qam_golden_rand(void)
+{
+  qam_golden_state ^= qam_golden_state >> 12;
+  qam_golden_state ^= qam_golden_state << 25;
+  qam_golden_state ^= qam_golden_state >> 27;
+  return qam_golden_state * 0x2545f4914f6cdd1dULL;
+}
+
+/// @brief Approximately Gaussian noise (Irwin-Hall) with standard deviation sigma
+static int32_t qam_golden_noise(int32_t sigma)
+{
+  int32_t acc = 0;
+  for (int i = 0; i < 12; i++)
+    acc += (int32_t)(qam_golden_rand() & 0xffff);
+  return (int32_t)(((int64_t)(acc - 6 * 65536) * sigma) >> 16);
+}
+
+/// @brief Writes one vector after computing its expected LLRs with the scalar reference
+static int qam_golden_write(const char *dir, const char *name, qam_vec_t *v)
+{
+  char path[1024];
+
+  qam_llr_ref(v->hdr.qm, v->rxF, (const int16_t *const *)v->chmag, v->hdr.nb_re, v->llr);
+  snprintf(path, sizeof(path), "%s/%s", dir, name);
+  if (qam_vec_write(path, v))
+  {
+    printf("Error: cannot write %s\n", path);
+    return -1;
+  }
+  printf("%s: qm = %d, nb_re = %u, scale = %d\n", path, v->hdr.qm, v->hdr.nb_re, v->hdr.scale);
+  return 0;
+}
+
+/// @brief Writes the demo symbols, a noisy 50-PRB allocation and a saturation case per modulation order
+static int qam_golden_generate(const char *dir)
+{
+  // Same symbols and channel magnitudes as the demo programs
+  static const int16_t rxFcomp[32] = {62, -63, 62, 19, 62, 60, -22, -60,
+                                      -61, -59, -61, -60, -61, -61, 61, 60,
+                                      20, -21, 22, 59, -59, 61, 60, 18,
+                                      19, -21, 18, -61, -21, -20, 21, 58};
+  static const int16_t dlchmag[3][32] = {{42, 42, 40, 40, 40, 40, 38, 38, 38, 38, 38, 38, 40, 40, 40, 40,
+                                          40, 40, 38, 38, 38, 38, 38, 38, 38, 38, 38, 38, 38, 38, 36, 36},
+                                         {16, 16, 16, 16, 18, 18, 18, 18, 18, 18, 18, 16, 16, 18, 18, 18,
+                                          16, 18, 18, 16, 16, 18, 18, 18, 16, 16, 18, 18, 18, 18, 18, 18},
+                                         {8, 8, 8, 8, 9, 9, 9, 9, 9, 9, 9, 8, 8, 9, 9, 9,
+                                          8, 9, 9, 8, 8, 9, 9, 9, 8, 8, 9, 9, 9, 9, 9, 9}};
+  static const int16_t edge[] = {INT16_MIN, INT16_MIN + 1, -1, 0, 1, INT16_MAX - 1, INT16_MAX};
+  char name[64];
+  qam_vec_t v;
+
+  for (int qm = 4; qm <= 8; qm += 2)
+  {
+    int nb_chmag = QAM_NB_CHMAG(qm), m = 1 << (qm / 2); // m points per dimension
+    const int32_t a = 64;
+
+    memset(&v, 0, sizeof(v));
+    memcpy(v.hdr.magic, QAM_VEC_MAGIC, 4);
+    v.hdr.version = QAM_VEC_VERSION;
+    v.hdr.qm = qm;
+
+    v.hdr.nb_re = 16;
+    v.hdr.scale = 0; // measured samples, not drawn at a known amplitude
+    if (qam_vec_alloc(&v))
+      return -1;
+    memcpy(v.rxF, rxFcomp, sizeof(rxFcomp));
+    for (int l = 0; l < nb_chmag; l++)
+      memcpy(v.chmag[l], dlchmag[l], sizeof(dlchmag[l]));
+    snprintf(name, sizeof(name), "qam%d-demo.qv", 1 << qm);
+    if (qam_golden_write(dir, name, &v))
+      return -1;
+    qam_vec_free(&v);
+
+    // Gray-mapped square constellation with per-RE channel gain in [0.5, 1.5) and noise
+    memcpy(v.hdr.magic, QAM_VEC_MAGIC, 4);
+    v.hdr.version = QAM_VEC_VERSION;
+    v.hdr.qm = qm;
+    v.hdr.nb_re = 50 * QAM_NB_RE_PRB;
+    v.hdr.scale = a;
+    if (qam_vec_alloc(&v))
+      return -1;
+    for (uint32_t i = 0; i < 2 * v.hdr.nb_re; i += 2)
+    {
+      int32_t g = 128 + (int32_t)(qam_golden_rand() % 256); // Q8 channel gain
+      for (int c = 0; c < 2; c++)
+      {
+        int32_t x = (2 * (int32_t)(qam_golden_rand() % m) - (m - 1)) * a;
+        v.rxF[i + c] = (int16_t)((x * g >> 8) + qam_golden_noise(a / 3));
+        for (int l = 0; l < nb_chmag; l++)
+          v.chmag[l][i + c] = (int16_t)(((a << (nb_chmag - l)) * g) >> 8);
+      }
+    }
+    snprintf(name, sizeof(name), "qam%d-50prb.qv", 1 << qm);
+    if (qam_golden_write(dir, name, &v))
+      return -1;
+    qam_vec_free(&v);
+
+    // Saturation edge cases on rxF and chmag
+    memcpy(v.hdr.magic, QAM_VEC_MAGIC, 4);
+    v.hdr.version = QAM_VEC_VERSION;
+    v.hdr.qm = qm;
+    v.hdr.nb_re = 3 * QAM_NB_RE_PRB + 5;
+    v.hdr.scale = 0; // edge values, no constellation
+    if (qam_vec_alloc(&v))
+      return -1;
+    for (uint32_t i = 0; i < 2 * v.hdr.nb_re; i++)
+    {
+      v.rxF[i] = edge[qam_golden_rand() % (sizeof(edge) / sizeof(edge[0]))];
+      for (int l = 0; l < nb_chmag; l++)
+        v.chmag[l][i] = edge[qam_golden_rand() % (sizeof(edge) / sizeof(edge[0]))];
+    }
+    snprintf(name, sizeof(name), "qam%d-sat.qv", 1 << qm);
+    if (qam_golden_write(dir, name, &v))
+      return -1;
+    qam_vec_free(&v);
+  }
+
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  const char *baseline_path = NULL;
+  double tolerance = 10, min_ms = 20;
+  int update = 0, opt, s = 0, e = 0, regressions = 0;
+  FILE *out = NULL;
+
+  while ((opt = getopt(argc, argv, "g:b:ut:m:")) != -1)
+  {
+    switch (opt)
+    {
+    case 'g':
+      return qam_golden_generate(optarg) ? 1 : 0;
+    case 'b':
+      baseline_path = optarg;
+      break;
+    case 'u':
+      update = 1;
+      break;
+    case 't':
+      tolerance = atof(optarg);
+      break;
+    case 'm':
+      min_ms = atof(optarg);
+      break;
+    default:
+      fprintf(stderr, "usage: %s -g dir | [-b baseline] [-u] [-t pct] [-m ms] vector...\n", argv[0]);
+      return 2;
+    }
+  }
+
+  if (baseline_path && !update && qam_golden_load_baseline(baseline_path))
+  {
+    printf("Error: cannot read baseline %s\n", baseline_path);
+    return 1;
+  }
+  if (baseline_path && update && !(out = fopen(baseline_path, "w")))
+  {
+    printf("Error: cannot write baseline %s\n", baseline_path);
+    return 1;
+  }
+  if (out)
+    fprintf(out, "# vector kernel MRE/s\n");
+  if (optind == argc)
+  {
+    printf("Error: no vector given\n");
+    e++;
+  }
+
+  for (int a = optind; a < argc; a++)
+  {
+    qam_vec_t v;
+    const char *name = basename_of(argv[a]);
+
+    if (qam_vec_read(argv[a], &v))
+    {
+      printf("Error: cannot read vector %s\n", argv[a]);
+      e++;
+      continue;
+    }
+
+    uint32_t nb_re = v.hdr.nb_re;
+    if (v.hdr.scale)
+      printf("%s: qm = %d, nb_re = %u, scale = %d\n", name, v.hdr.qm, nb_re, v.hdr.scale);
+    else
+      printf("%s: qm = %d, nb_re = %u, scale unknown\n", name, v.hdr.qm, nb_re);
+    int16_t *llr = aligned_alloc(32, ((size_t)nb_re * v.hdr.qm * sizeof(int16_t) + 63) & ~(size_t)31);
+    hard_buf = malloc(nb_re + 8);
+    mask_buf = malloc(nb_re / 8 + 1);
+    stats_buf = malloc((nb_re / QAM_NB_RE_PRB + 1) * sizeof(*stats_buf));
+    qam_golden_mask(mask_buf, nb_re);
+
+    for (size_t k = 0; k < NB_KERNELS; k++)
+    {
+      uint32_t nb = kernels[k].run(&v, llr), bad = qam_golden_check(k, &v, nb, llr);
+
+      if (bad)
+      {
+        printf("Error: %s %s: %u of %u LLRs or hard bits differ\n", name, kernels[k].name, bad, nb * v.hdr.qm);
+        e++;
+        continue;
+      }
+      s++;
+
+      double mres = qam_golden_time(k, &v, llr, min_ms);
+      double ref = qam_golden_baseline(name, kernels[k].name);
+      if (out)
+        fprintf(out, "%s %s %.3f\n", name, kernels[k].name, mres);
+      if (baseline_path && !update && ref <= 0)
+      {
+        printf("Error: %s %s = %.1f MRE/s, not in baseline %s\n", name, kernels[k].name, mres, baseline_path);
+        e++;
+      }
+      else if (ref > 0 && mres < ref * (1 - tolerance / 100))
+      {
+        printf("Regression: %s %s = %.1f MRE/s, baseline = %.1f MRE/s (%.1f%%)\n", name, kernels[k].name, mres, ref,
+               100 * (mres - ref) / ref);
+        regressions++;
+      }
+      else
+        printf("%s %s = %.1f MRE/s%s\n", name, kernels[k].name, mres, (ref > 0) ? "" : " (no baseline)");
+    }
+
+    free(llr);
+    free(hard_buf);
+    free(mask_buf);
+    free(stats_buf);
+    qam_vec_free(&v);
+  }
+
+  if (out)
+    fclose(out);
+  printf("Success = %d, Error = %d, Regression = %d\n", s, e, regressions);
+
+  return (e || regressions) ? 1 : 0;
+}
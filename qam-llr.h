@@ -0,0 +1,1803 @@
+/// @brief SSE/AVX2 Log-Likelihood Ratio (LLR) kernels for 16/64/256-QAM
+///
+/// Buffers follow the layout of the demo programs: rxF holds interleaved (I, Q)
+/// int16 pairs, one pair per RE, and every chmag level uses the same layout as rxF.
+/// Each RE produces qm int16 LLRs in the order
+/// [I, Q, chmag1 - |I|, chmag1 - |Q|, chmag2 - |chmag1 - |I||, ...].
+///
+
+#ifndef QAM_LLR_H
+#define QAM_LLR_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <tmmintrin.h> // SSSE3
+#include <emmintrin.h> // SSE2
+#include <smmintrin.h> // SSE4.1
+
+#include <immintrin.h> // AVX
+
+/// @brief Number of channel magnitude levels of the max-log recursion for a modulation order
+#define QAM_NB_CHMAG(qm) ((qm) / 2 - 1)
+
+/// @brief Scalar equivalent of _mm_abs_epi16 (INT16_MIN stays INT16_MIN)
+static inline int16_t qam_abs16(int16_t x)
+{
+  return (x == INT16_MIN) ? INT16_MIN : (x < 0 ? -x : x);
+}
+
+/// @brief Scalar equivalent of _mm_subs_epi16
+static inline int16_t qam_subs16(int16_t a, int16_t b)
+{
+  int32_t d = (int32_t)a - (int32_t)b;
+  return (d > INT16_MAX) ? INT16_MAX : (d < INT16_MIN) ? INT16_MIN : (int16_t)d;
+}
+
+/// @brief Scalar LLR of RE number re, used for the tails of the vector loops
+static inline void qam_llr_re(int qm, const int16_t *rxF, const int16_t *const *chmag, uint32_t re, int16_t *llr)
+{
+  int16_t yi = rxF[2 * re], yq = rxF[2 * re + 1];
+
+  llr[0] = yi;
+  llr[1] = yq;
+  for (int l = 0; l < QAM_NB_CHMAG(qm); l++)
+  {
+    yi = qam_subs16(chmag[l][2 * re], qam_abs16(yi));
+    yq = qam_subs16(chmag[l][2 * re + 1], qam_abs16(yq));
+    llr[2 * l + 2] = yi;
+    llr[2 * l + 3] = yq;
+  }
+}
+
+/// ------------------------------- Scalar reference -------------------------------
+
+/// @brief Scalar reference LLRs for 16-QAM, bit-exact with the SIMD kernels
+static inline void qam16_llr_ref(const int16_t *rxF, const int16_t *chmag, uint32_t nb_re, int16_t *llr)
+{
+  for (uint32_t i = 0; i < 2 * nb_re; i += 2, llr += 4)
+  {
+    llr[0] = rxF[i];
+    llr[1] = rxF[i + 1];
+    llr[2] = qam_subs16(chmag[i], qam_abs16(rxF[i]));
+    llr[3] = qam_subs16(chmag[i + 1], qam_abs16(rxF[i + 1]));
+  }
+}
+
+/// @brief Scalar reference LLRs for 64-QAM, bit-exact with the SIMD kernels
+static inline void qam64_llr_ref(const int16_t *rxF, const int16_t *chmag1, const int16_t *chmag2, uint32_t nb_re,
+                                 int16_t *llr)
+{
+  for (uint32_t i = 0; i < 2 * nb_re; i += 2, llr += 6)
+  {
+    llr[0] = rxF[i];
+    llr[1] = rxF[i + 1];
+    llr[2] = qam_subs16(chmag1[i], qam_abs16(llr[0]));
+    llr[3] = qam_subs16(chmag1[i + 1], qam_abs16(llr[1]));
+    llr[4] = qam_subs16(chmag2[i], qam_abs16(llr[2]));
+    llr[5] = qam_subs16(chmag2[i + 1], qam_abs16(llr[3]));
+  }
+}
+
+/// @brief Scalar reference LLRs for 256-QAM, bit-exact with the SIMD kernels
+static inline void qam256_llr_ref(const int16_t *rxF, const int16_t *chmag1, const int16_t *chmag2,
+                                  const int16_t *chmag3, uint32_t nb_re, int16_t *llr)
+{
+  for (uint32_t i = 0; i < 2 * nb_re; i += 2, llr += 8)
+  {
+    llr[0] = rxF[i];
+    llr[1] = rxF[i + 1];
+    llr[2] = qam_subs16(chmag1[i], qam_abs16(llr[0]));
+    llr[3] = qam_subs16(chmag1[i + 1], qam_abs16(llr[1]));
+    llr[4] = qam_subs16(chmag2[i], qam_abs16(llr[2]));
+    llr[5] = qam_subs16(chmag2[i + 1], qam_abs16(llr[3]));
+    llr[6] = qam_subs16(chmag3[i], qam_abs16(llr[4]));
+    llr[7] = qam_subs16(chmag3[i + 1], qam_abs16(llr[5]));
+  }
+}
+
+/// @brief Scalar reference LLRs for any supported modulation order
+static inline void qam_llr_ref(int qm, const int16_t *rxF, const int16_t *const *chmag, uint32_t nb_re, int16_t *llr)
+{
+  if (qm == 4)
+    qam16_llr_ref(rxF, chmag[0], nb_re, llr);
+  else if (qm == 6)
+    qam64_llr_ref(rxF, chmag[0], chmag[1], nb_re, llr);
+  else if (qm == 8)
+    qam256_llr_ref(rxF, chmag[0], chmag[1], chmag[2], nb_re, llr);
+}
+
+/// ------------------------------------- SSE -------------------------------------
+
+/// @brief Max-log recursion on 4 REs: y[l + 1] = chmag_l - |y[l]|, y[0] holds rxF on entry
+static inline void qam_llr_core_sse(int qm, __m128i *y, const int16_t *const *chmag, uint32_t re)
+{
+  for (int l = 0; l < QAM_NB_CHMAG(qm); l++)
+    y[l + 1] = _mm_subs_epi16(_mm_loadu_si128((const __m128i *)&chmag[l][2 * re]), _mm_abs_epi16(y[l]));
+}
+
+/// @brief Interleaves the recursion outputs of 4 REs into qm / 2 vectors holding the LLRs in output order
+static inline void qam_llr_interleave_sse(int qm, const __m128i *y, __m128i *v)
+{
+  if (qm == 4)
+  {
+    v[0] = _mm_unpacklo_epi32(y[0], y[1]);
+    v[1] = _mm_unpackhi_epi32(y[0], y[1]);
+  }
+  else if (qm == 8)
+  {
+    __m128i a = _mm_unpacklo_epi32(y[0], y[1]), b = _mm_unpacklo_epi32(y[2], y[3]);
+    __m128i c = _mm_unpackhi_epi32(y[0], y[1]), d = _mm_unpackhi_epi32(y[2], y[3]);
+    v[0] = _mm_unpacklo_epi64(a, b);
+    v[1] = _mm_unpackhi_epi64(a, b);
+    v[2] = _mm_unpacklo_epi64(c, d);
+    v[3] = _mm_unpackhi_epi64(c, d);
+  }
+  else
+  {
+    int16_t t[4][8] __attribute__((aligned(16))), u[4 * 8] __attribute__((aligned(16)));
+    for (int l = 0; l <= QAM_NB_CHMAG(qm); l++)
+      _mm_store_si128((__m128i *)t[l], y[l]);
+    for (int k = 0; k < 4; k++)
+      for (int l = 0; l <= QAM_NB_CHMAG(qm); l++)
+      {
+        u[k * qm + 2 * l] = t[l][2 * k];
+        u[k * qm + 2 * l + 1] = t[l][2 * k + 1];
+      }
+    for (int k = 0; k < qm / 2; k++)
+      v[k] = _mm_load_si128((const __m128i *)&u[8 * k]);
+  }
+}
+
+/// @brief Stores the qm LLRs of each of 4 REs
+static inline void qam_llr_store_sse(int qm, const __m128i *y, int16_t *llr)
+{
+  __m128i v[4];
+
+  qam_llr_interleave_sse(qm, y, v);
+  for (int k = 0; k < qm / 2; k++)
+    _mm_storeu_si128((__m128i *)&llr[8 * k], v[k]);
+}
+
+/// @brief LLRs of nb_re contiguous REs using SSE
+static inline void qam_llr_sse(int qm, const int16_t *rxF, const int16_t *const *chmag, uint32_t nb_re, int16_t *llr)
+{
+  __m128i y[4];
+  uint32_t i = 0;
+
+  for (; i + 4 <= nb_re; i += 4)
+  {
+    y[0] = _mm_loadu_si128((const __m128i *)&rxF[2 * i]);
+    qam_llr_core_sse(qm, y, chmag, i);
+    qam_llr_store_sse(qm, y, &llr[i * qm]);
+  }
+  for (; i < nb_re; i++)
+    qam_llr_re(qm, rxF, chmag, i, &llr[i * qm]);
+}
+
+/// @brief LLRs of nb_re contiguous REs using SSE with non-temporal stores
+///
+/// The LLRs bypass the cache, which pays off when the output is much larger than the cache and
+/// is not read back right away. llr must be 16-byte aligned, otherwise the cached stores are used.
+static inline void qam_llr_sse_nt(int qm, const int16_t *rxF, const int16_t *const *chmag, uint32_t nb_re,
+                                  int16_t *llr)
+{
+  __m128i y[4], v[4];
+  uint32_t i = 0;
+
+  if ((uintptr_t)llr & 15)
+  {
+    qam_llr_sse(qm, rxF, chmag, nb_re, llr);
+    return;
+  }
+  for (; i + 4 <= nb_re; i += 4)
+  {
+    y[0] = _mm_loadu_si128((const __m128i *)&rxF[2 * i]);
+    qam_llr_core_sse(qm, y, chmag, i);
+    qam_llr_interleave_sse(qm, y, v);
+    for (int k = 0; k < qm / 2; k++)
+      _mm_stream_si128((__m128i *)&llr[i * qm + 8 * k], v[k]);
+  }
+  _mm_sfence();
+  for (; i < nb_re; i++)
+    qam_llr_re(qm, rxF, chmag, i, &llr[i * qm]);
+}
+
+/// ------------------------------------- AVX -------------------------------------
+
+/// @brief Max-log recursion on 8 REs: y[l + 1] = chmag_l - |y[l]|, y[0] holds rxF on entry
+static inline void qam_llr_core_avx(int qm, __m256i *y, const int16_t *const *chmag, uint32_t re)
+{
+  for (int l = 0; l < QAM_NB_CHMAG(qm); l++)
+    y[l + 1] = _mm256_subs_epi16(_mm256_loadu_si256((const __m256i *)&chmag[l][2 * re]), _mm256_abs_epi16(y[l]));
+}
+
+/// @brief Interleaves the recursion outputs of 8 REs into qm / 2 vectors holding the LLRs in output order
+static inline void qam_llr_interleave_avx(int qm, const __m256i *y, __m256i *v)
+{
+  if (qm == 4)
+  {
+    // unpack works per 128-bit lane: lo = REs {0, 1 | 4, 5}, hi = REs {2, 3 | 6, 7}
+    __m256i lo = _mm256_unpacklo_epi32(y[0], y[1]), hi = _mm256_unpackhi_epi32(y[0], y[1]);
+    v[0] = _mm256_permute2x128_si256(lo, hi, 0x20);
+    v[1] = _mm256_permute2x128_si256(lo, hi, 0x31);
+  }
+  else if (qm == 8)
+  {
+    __m256i a = _mm256_unpacklo_epi32(y[0], y[1]), b = _mm256_unpacklo_epi32(y[2], y[3]);
+    __m256i c = _mm256_unpackhi_epi32(y[0], y[1]), d = _mm256_unpackhi_epi32(y[2], y[3]);
+    __m256i e0 = _mm256_unpacklo_epi64(a, b), e1 = _mm256_unpackhi_epi64(a, b); // REs {0 | 4}, {1 | 5}
+    __m256i e2 = _mm256_unpacklo_epi64(c, d), e3 = _mm256_unpackhi_epi64(c, d); // REs {2 | 6}, {3 | 7}
+    v[0] = _mm256_permute2x128_si256(e0, e1, 0x20);
+    v[1] = _mm256_permute2x128_si256(e2, e3, 0x20);
+    v[2] = _mm256_permute2x128_si256(e0, e1, 0x31);
+    v[3] = _mm256_permute2x128_si256(e2, e3, 0x31);
+  }
+  else
+  {
+    int16_t t[4][16] __attribute__((aligned(32))), u[8 * 8] __attribute__((aligned(32)));
+    for (int l = 0; l <= QAM_NB_CHMAG(qm); l++)
+      _mm256_store_si256((__m256i *)t[l], y[l]);
+    for (int k = 0; k < 8; k++)
+      for (int l = 0; l <= QAM_NB_CHMAG(qm); l++)
+      {
+        u[k * qm + 2 * l] = t[l][2 * k];
+        u[k * qm + 2 * l + 1] = t[l][2 * k + 1];
+      }
+    for (int k = 0; k < qm / 2; k++)
+      v[k] = _mm256_load_si256((const __m256i *)&u[16 * k]);
+  }
+}
+
+/// @brief Stores the qm LLRs of each of 8 REs
+static inline void qam_llr_store_avx(int qm, const __m256i *y, int16_t *llr)
+{
+  __m256i v[4];
+
+  qam_llr_interleave_avx(qm, y, v);
+  for (int k = 0; k < qm / 2; k++)
+    _mm256_storeu_si256((__m256i *)&llr[16 * k], v[k]);
+}
+
+/// @brief LLRs of nb_re contiguous REs using AVX2
+static inline void qam_llr_avx(int qm, const int16_t *rxF, const int16_t *const *chmag, uint32_t nb_re, int16_t *llr)
+{
+  __m256i y[4];
+  uint32_t i = 0;
+
+  for (; i + 8 <= nb_re; i += 8)
+  {
+    y[0] = _mm256_loadu_si256((const __m256i *)&rxF[2 * i]);
+    qam_llr_core_avx(qm, y, chmag, i);
+    qam_llr_store_avx(qm, y, &llr[i * qm]);
+  }
+  for (; i < nb_re; i++)
+    qam_llr_re(qm, rxF, chmag, i, &llr[i * qm]);
+}
+
+/// @brief LLRs of nb_re contiguous REs using AVX2 with non-temporal stores, see qam_llr_sse_nt()
+/// llr must be 32-byte aligned, otherwise the cached stores are used.
+static inline void qam_llr_avx_nt(int qm, const int16_t *rxF, const int16_t *const *chmag, uint32_t nb_re,
+                                  int16_t *llr)
+{
+  __m256i y[4], v[4];
+  uint32_t i = 0;
+
+  if ((uintptr_t)llr & 31)
+  {
+    qam_llr_avx(qm, rxF, chmag, nb_re, llr);
+    return;
+  }
+  for (; i + 8 <= nb_re; i += 8)
+  {
+    y[0] = _mm256_loadu_si256((const __m256i *)&rxF[2 * i]);
+    qam_llr_core_avx(qm, y, chmag, i);
+    qam_llr_interleave_avx(qm, y, v);
+    for (int k = 0; k < qm / 2; k++)
+      _mm256_stream_si256((__m256i *)&llr[i * qm + 16 * k], v[k]);
+  }
+  _mm_sfence();
+  for (; i < nb_re; i++)
+    qam_llr_re(qm, rxF, chmag, i, &llr[i * qm]);
+}
+
+/// ----------------------------------- AVX-512 -----------------------------------
+
+#ifdef __AVX512BW__
+/// @brief Max-log recursion on 16 REs: y[l + 1] = chmag_l - |y[l]|, y[0] holds rxF on entry
+static inline void qam_llr_core_avx512(int qm, __m512i *y, const int16_t *const *chmag, uint32_t re)
+{
+  for (int l = 0; l < QAM_NB_CHMAG(qm); l++)
+    y[l + 1] = _mm512_subs_epi16(_mm512_loadu_si512((const void *)&chmag[l][2 * re]), _mm512_abs_epi16(y[l]));
+}
+
+/// @brief Interleaves the recursion outputs of 16 REs into qm / 2 vectors holding the LLRs in output order
+///
+/// Each RE is one 32-bit (I, Q) lane of every y[l], so the interleave is a dword transpose done
+/// with two-source permutes across the whole register instead of the per-lane unpacks of AVX2.
+static inline void qam_llr_interleave_avx512(int qm, const __m512i *y, __m512i *v)
+{
+  const __m512i lo = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+  const __m512i hi = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+
+  if (qm == 4)
+  {
+    v[0] = _mm512_permutex2var_epi32(y[0], lo, y[1]);
+    v[1] = _mm512_permutex2var_epi32(y[0], hi, y[1]);
+  }
+  else if (qm == 8)
+  {
+    const __m512i lo64 = _mm512_setr_epi64(0, 8, 1, 9, 2, 10, 3, 11);
+    const __m512i hi64 = _mm512_setr_epi64(4, 12, 5, 13, 6, 14, 7, 15);
+    __m512i a0 = _mm512_permutex2var_epi32(y[0], lo, y[1]), a1 = _mm512_permutex2var_epi32(y[0], hi, y[1]);
+    __m512i b0 = _mm512_permutex2var_epi32(y[2], lo, y[3]), b1 = _mm512_permutex2var_epi32(y[2], hi, y[3]);
+    v[0] = _mm512_permutex2var_epi64(a0, lo64, b0);
+    v[1] = _mm512_permutex2var_epi64(a0, hi64, b0);
+    v[2] = _mm512_permutex2var_epi64(a1, lo64, b1);
+    v[3] = _mm512_permutex2var_epi64(a1, hi64, b1);
+  }
+  else
+  {
+    // output dword g is RE g / 3, level g % 3: levels 0 and 1 from one permute, level 2 merged under a mask
+    const __m512i idx01[3] = {_mm512_setr_epi32(0, 16, 0, 1, 17, 0, 2, 18, 0, 3, 19, 0, 4, 20, 0, 5),
+                              _mm512_setr_epi32(21, 0, 6, 22, 0, 7, 23, 0, 8, 24, 0, 9, 25, 0, 10, 26),
+                              _mm512_setr_epi32(0, 11, 27, 0, 12, 28, 0, 13, 29, 0, 14, 30, 0, 15, 31, 0)};
+    const __m512i idx2[3] = {_mm512_setr_epi32(0, 0, 0, 0, 0, 1, 0, 0, 2, 0, 0, 3, 0, 0, 4, 0),
+                             _mm512_setr_epi32(0, 5, 0, 0, 6, 0, 0, 7, 0, 0, 8, 0, 0, 9, 0, 0),
+                             _mm512_setr_epi32(10, 0, 0, 11, 0, 0, 12, 0, 0, 13, 0, 0, 14, 0, 0, 15)};
+    const __mmask16 m2[3] = {0x4924, 0x2492, 0x9249};
+    for (int k = 0; k < 3; k++)
+      v[k] = _mm512_mask_permutexvar_epi32(_mm512_permutex2var_epi32(y[0], idx01[k], y[1]), m2[k], idx2[k], y[2]);
+  }
+}
+
+/// @brief Stores the qm LLRs of each of 16 REs
+static inline void qam_llr_store_avx512(int qm, const __m512i *y, int16_t *llr)
+{
+  __m512i v[4];
+
+  qam_llr_interleave_avx512(qm, y, v);
+  for (int k = 0; k < qm / 2; k++)
+    _mm512_storeu_si512((void *)&llr[32 * k], v[k]);
+}
+
+/// @brief LLRs of nb_re contiguous REs using AVX-512BW, the last 8 REs or fewer go through AVX2
+static inline void qam_llr_avx512(int qm, const int16_t *rxF, const int16_t *const *chmag, uint32_t nb_re,
+                                  int16_t *llr)
+{
+  __m512i y[4];
+  uint32_t i = 0;
+
+  for (; i + 16 <= nb_re; i += 16)
+  {
+    y[0] = _mm512_loadu_si512((const void *)&rxF[2 * i]);
+    qam_llr_core_avx512(qm, y, chmag, i);
+    qam_llr_store_avx512(qm, y, &llr[i * qm]);
+  }
+  if (i < nb_re)
+  {
+    const int16_t *c[3];
+    for (int l = 0; l < QAM_NB_CHMAG(qm); l++)
+      c[l] = &chmag[l][2 * i];
+    qam_llr_avx(qm, &rxF[2 * i], c, nb_re - i, &llr[i * qm]);
+  }
+}
+
+/// @brief LLRs of nb_re contiguous REs using AVX-512BW with non-temporal stores, see qam_llr_sse_nt()
+/// llr must be 64-byte aligned, otherwise the cached stores are used.
+static inline void qam_llr_avx512_nt(int qm, const int16_t *rxF, const int16_t *const *chmag, uint32_t nb_re,
+                                     int16_t *llr)
+{
+  __m512i y[4], v[4];
+  uint32_t i = 0;
+
+  if ((uintptr_t)llr & 63)
+  {
+    qam_llr_avx512(qm, rxF, chmag, nb_re, llr);
+    return;
+  }
+  for (; i + 16 <= nb_re; i += 16)
+  {
+    y[0] = _mm512_loadu_si512((const void *)&rxF[2 * i]);
+    qam_llr_core_avx512(qm, y, chmag, i);
+    qam_llr_interleave_avx512(qm, y, v);
+    for (int k = 0; k < qm / 2; k++)
+      _mm512_stream_si512((void *)&llr[i * qm + 32 * k], v[k]);
+  }
+  _mm_sfence();
+  for (; i < nb_re; i++)
+    qam_llr_re(qm, rxF, chmag, i, &llr[i * qm]);
+}
+#endif
+
+/// ------------------------------ Sparse (DMRS/PTRS) ------------------------------
+
+/// @brief Packed byte indices of the set bits of an 8-bit RE mask, lowest RE first
+static const uint64_t qam_re_compress_idx[256] = {
+    0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000001ULL, 0x0000000000000100ULL,
+    0x0000000000000002ULL, 0x0000000000000200ULL, 0x0000000000000201ULL, 0x0000000000020100ULL,
+    0x0000000000000003ULL, 0x0000000000000300ULL, 0x0000000000000301ULL, 0x0000000000030100ULL,
+    0x0000000000000302ULL, 0x0000000000030200ULL, 0x0000000000030201ULL, 0x0000000003020100ULL,
+    0x0000000000000004ULL, 0x0000000000000400ULL, 0x0000000000000401ULL, 0x0000000000040100ULL,
+    0x0000000000000402ULL, 0x0000000000040200ULL, 0x0000000000040201ULL, 0x0000000004020100ULL,
+    0x0000000000000403ULL, 0x0000000000040300ULL, 0x0000000000040301ULL, 0x0000000004030100ULL,
+    0x0000000000040302ULL, 0x0000000004030200ULL, 0x0000000004030201ULL, 0x0000000403020100ULL,
+    0x0000000000000005ULL, 0x0000000000000500ULL, 0x0000000000000501ULL, 0x0000000000050100ULL,
+    0x0000000000000502ULL, 0x0000000000050200ULL, 0x0000000000050201ULL, 0x0000000005020100ULL,
+    0x0000000000000503ULL, 0x0000000000050300ULL, 0x0000000000050301ULL, 0x0000000005030100ULL,
+    0x0000000000050302ULL, 0x0000000005030200ULL, 0x0000000005030201ULL, 0x0000000503020100ULL,
+    0x0000000000000504ULL, 0x0000000000050400ULL, 0x0000000000050401ULL, 0x0000000005040100ULL,
+    0x0000000000050402ULL, 0x0000000005040200ULL, 0x0000000005040201ULL, 0x0000000504020100ULL,
+    0x0000000000050403ULL, 0x0000000005040300ULL, 0x0000000005040301ULL, 0x0000000504030100ULL,
+    0x0000000005040302ULL, 0x0000000504030200ULL, 0x0000000504030201ULL, 0x0000050403020100ULL,
+    0x0000000000000006ULL, 0x0000000000000600ULL, 0x0000000000000601ULL, 0x0000000000060100ULL,
+    0x0000000000000602ULL, 0x0000000000060200ULL, 0x0000000000060201ULL, 0x0000000006020100ULL,
+    0x0000000000000603ULL, 0x0000000000060300ULL, 0x0000000000060301ULL, 0x0000000006030100ULL,
+    0x0000000000060302ULL, 0x0000000006030200ULL, 0x0000000006030201ULL, 0x0000000603020100ULL,
+    0x0000000000000604ULL, 0x0000000000060400ULL, 0x0000000000060401ULL, 0x0000000006040100ULL,
+    0x0000000000060402ULL, 0x0000000006040200ULL, 0x0000000006040201ULL, 0x0000000604020100ULL,
+    0x0000000000060403ULL, 0x0000000006040300ULL, 0x0000000006040301ULL, 0x0000000604030100ULL,
+    0x0000000006040302ULL, 0x0000000604030200ULL, 0x0000000604030201ULL, 0x0000060403020100ULL,
+    0x0000000000000605ULL, 0x0000000000060500ULL, 0x0000000000060501ULL, 0x0000000006050100ULL,
+    0x0000000000060502ULL, 0x0000000006050200ULL, 0x0000000006050201ULL, 0x0000000605020100ULL,
+    0x0000000000060503ULL, 0x0000000006050300ULL, 0x0000000006050301ULL, 0x0000000605030100ULL,
+    0x0000000006050302ULL, 0x0000000605030200ULL, 0x0000000605030201ULL, 0x0000060503020100ULL,
+    0x0000000000060504ULL, 0x0000000006050400ULL, 0x0000000006050401ULL, 0x0000000605040100ULL,
+    0x0000000006050402ULL, 0x0000000605040200ULL, 0x0000000605040201ULL, 0x0000060504020100ULL,
+    0x0000000006050403ULL, 0x0000000605040300ULL, 0x0000000605040301ULL, 0x0000060504030100ULL,
+    0x0000000605040302ULL, 0x0000060504030200ULL, 0x0000060504030201ULL, 0x0006050403020100ULL,
+    0x0000000000000007ULL, 0x0000000000000700ULL, 0x0000000000000701ULL, 0x0000000000070100ULL,
+    0x0000000000000702ULL, 0x0000000000070200ULL, 0x0000000000070201ULL, 0x0000000007020100ULL,
+    0x0000000000000703ULL, 0x0000000000070300ULL, 0x0000000000070301ULL, 0x0000000007030100ULL,
+    0x0000000000070302ULL, 0x0000000007030200ULL, 0x0000000007030201ULL, 0x0000000703020100ULL,
+    0x0000000000000704ULL, 0x0000000000070400ULL, 0x0000000000070401ULL, 0x0000000007040100ULL,
+    0x0000000000070402ULL, 0x0000000007040200ULL, 0x0000000007040201ULL, 0x0000000704020100ULL,
+    0x0000000000070403ULL, 0x0000000007040300ULL, 0x0000000007040301ULL, 0x0000000704030100ULL,
+    0x0000000007040302ULL, 0x0000000704030200ULL, 0x0000000704030201ULL, 0x0000070403020100ULL,
+    0x0000000000000705ULL, 0x0000000000070500ULL, 0x0000000000070501ULL, 0x0000000007050100ULL,
+    0x0000000000070502ULL, 0x0000000007050200ULL, 0x0000000007050201ULL, 0x0000000705020100ULL,
+    0x0000000000070503ULL, 0x0000000007050300ULL, 0x0000000007050301ULL, 0x0000000705030100ULL,
+    0x0000000007050302ULL, 0x0000000705030200ULL, 0x0000000705030201ULL, 0x0000070503020100ULL,
+    0x0000000000070504ULL, 0x0000000007050400ULL, 0x0000000007050401ULL, 0x0000000705040100ULL,
+    0x0000000007050402ULL, 0x0000000705040200ULL, 0x0000000705040201ULL, 0x0000070504020100ULL,
+    0x0000000007050403ULL, 0x0000000705040300ULL, 0x0000000705040301ULL, 0x0000070504030100ULL,
+    0x0000000705040302ULL, 0x0000070504030200ULL, 0x0000070504030201ULL, 0x0007050403020100ULL,
+    0x0000000000000706ULL, 0x0000000000070600ULL, 0x0000000000070601ULL, 0x0000000007060100ULL,
+    0x0000000000070602ULL, 0x0000000007060200ULL, 0x0000000007060201ULL, 0x0000000706020100ULL,
+    0x0000000000070603ULL, 0x0000000007060300ULL, 0x0000000007060301ULL, 0x0000000706030100ULL,
+    0x0000000007060302ULL, 0x0000000706030200ULL, 0x0000000706030201ULL, 0x0000070603020100ULL,
+    0x0000000000070604ULL, 0x0000000007060400ULL, 0x0000000007060401ULL, 0x0000000706040100ULL,
+    0x0000000007060402ULL, 0x0000000706040200ULL, 0x0000000706040201ULL, 0x0000070604020100ULL,
+    0x0000000007060403ULL, 0x0000000706040300ULL, 0x0000000706040301ULL, 0x0000070604030100ULL,
+    0x0000000706040302ULL, 0x0000070604030200ULL, 0x0000070604030201ULL, 0x0007060403020100ULL,
+    0x0000000000070605ULL, 0x0000000007060500ULL, 0x0000000007060501ULL, 0x0000000706050100ULL,
+    0x0000000007060502ULL, 0x0000000706050200ULL, 0x0000000706050201ULL, 0x0000070605020100ULL,
+    0x0000000007060503ULL, 0x0000000706050300ULL, 0x0000000706050301ULL, 0x0000070605030100ULL,
+    0x0000000706050302ULL, 0x0000070605030200ULL, 0x0000070605030201ULL, 0x0007060503020100ULL,
+    0x0000000007060504ULL, 0x0000000706050400ULL, 0x0000000706050401ULL, 0x0000070605040100ULL,
+    0x0000000706050402ULL, 0x0000070605040200ULL, 0x0000070605040201ULL, 0x0007060504020100ULL,
+    0x0000000706050403ULL, 0x0000070605040300ULL, 0x0000070605040301ULL, 0x0007060504030100ULL,
+    0x0000070605040302ULL, 0x0007060504030200ULL, 0x0007060504030201ULL, 0x0706050403020100ULL,
+};
+
+/// @brief Moves the REs (32-bit I/Q pairs) selected by a 4-bit mask to the low lanes
+static inline __m128i qam_re_compress_sse(__m128i x, unsigned m)
+{
+  // RE index k becomes byte indices 4k .. 4k + 3
+  __m128i idx = _mm_cvtepu8_epi32(_mm_cvtsi32_si128((int)qam_re_compress_idx[m]));
+  idx = _mm_add_epi32(_mm_mullo_epi32(idx, _mm_set1_epi32(0x04040404)), _mm_set1_epi32(0x03020100));
+  return _mm_shuffle_epi8(x, idx);
+}
+
+/// @brief Moves the REs (32-bit I/Q pairs) selected by an 8-bit mask to the low lanes
+static inline __m256i qam_re_compress_avx(__m256i x, unsigned m)
+{
+#ifdef __AVX512VL__
+  return _mm256_maskz_compress_epi32((__mmask8)m, x);
+#else
+  return _mm256_permutevar8x32_epi32(x, _mm256_cvtepu8_epi32(_mm_cvtsi64_si128((long long)qam_re_compress_idx[m])));
+#endif
+}
+
+/// @brief LLRs of the data REs of one OFDM symbol read directly from the uncompacted grid (SSE)
+///
+/// Bit k of re_mask (LSB first) is set when RE k carries data; DMRS/PTRS REs are skipped
+/// and the LLRs of the data REs are written contiguously to llr.
+/// @return number of data REs demapped
+static inline uint32_t qam_llr_mask_sse(int qm, const int16_t *rxF, const int16_t *const *chmag,
+                                        const uint8_t *re_mask, uint32_t nb_re, int16_t *llr)
+{
+  __m128i y[4];
+  int16_t t[4 * 8] __attribute__((aligned(16)));
+  uint32_t i = 0, n = 0;
+
+  for (; i + 4 <= nb_re; i += 4)
+  {
+    unsigned m = (re_mask[i >> 3] >> (i & 4)) & 0xf;
+    if (m == 0)
+      continue;
+    y[0] = _mm_loadu_si128((const __m128i *)&rxF[2 * i]);
+    qam_llr_core_sse(qm, y, chmag, i);
+    if (m == 0xf)
+    {
+      qam_llr_store_sse(qm, y, &llr[n * qm]);
+      n += 4;
+      continue;
+    }
+    for (int l = 0; l <= QAM_NB_CHMAG(qm); l++)
+      y[l] = qam_re_compress_sse(y[l], m);
+    qam_llr_store_sse(qm, y, t);
+    memcpy(&llr[n * qm], t, __builtin_popcount(m) * qm * sizeof(int16_t));
+    n += __builtin_popcount(m);
+  }
+  for (; i < nb_re; i++)
+    if ((re_mask[i >> 3] >> (i & 7)) & 1)
+      qam_llr_re(qm, rxF, chmag, i, &llr[qm * n++]);
+
+  return n;
+}
+
+/// @brief LLRs of the data REs of one OFDM symbol read directly from the uncompacted grid (AVX2)
+///
+/// Same contract as qam_llr_mask_sse(); one mask byte covers the 8 REs of an AVX2 vector.
+/// @return number of data REs demapped
+static inline uint32_t qam_llr_mask_avx(int qm, const int16_t *rxF, const int16_t *const *chmag,
+                                        const uint8_t *re_mask, uint32_t nb_re, int16_t *llr)
+{
+  __m256i y[4];
+  int16_t t[8 * 8] __attribute__((aligned(32)));
+  uint32_t i = 0, n = 0;
+
+  for (; i + 8 <= nb_re; i += 8)
+  {
+    unsigned m = re_mask[i >> 3];
+    if (m == 0)
+      continue;
+    y[0] = _mm256_loadu_si256((const __m256i *)&rxF[2 * i]);
+    qam_llr_core_avx(qm, y, chmag, i);
+    if (m == 0xff)
+    {
+      qam_llr_store_avx(qm, y, &llr[n * qm]);
+      n += 8;
+      continue;
+    }
+    for (int l = 0; l <= QAM_NB_CHMAG(qm); l++)
+      y[l] = qam_re_compress_avx(y[l], m);
+    qam_llr_store_avx(qm, y, t);
+    memcpy(&llr[n * qm], t, __builtin_popcount(m) * qm * sizeof(int16_t));
+    n += __builtin_popcount(m);
+  }
+  for (; i < nb_re; i++)
+    if ((re_mask[i >> 3] >> (i & 7)) & 1)
+      qam_llr_re(qm, rxF, chmag, i, &llr[qm * n++]);
+
+  return n;
+}
+
+/// @brief LLRs of the REs listed in re_idx (grid indices), gathered from the uncompacted grid (AVX2)
+static inline void qam_llr_idx_avx(int qm, const int16_t *rxF, const int16_t *const *chmag,
+                                   const int32_t *re_idx, uint32_t nb_idx, int16_t *llr)
+{
+  __m256i y[4];
+  uint32_t i = 0;
+
+  for (; i + 8 <= nb_idx; i += 8)
+  {
+    __m256i idx = _mm256_loadu_si256((const __m256i *)&re_idx[i]);
+    y[0] = _mm256_i32gather_epi32((const int *)rxF, idx, 4);
+    for (int l = 0; l < QAM_NB_CHMAG(qm); l++)
+      y[l + 1] = _mm256_subs_epi16(_mm256_i32gather_epi32((const int *)chmag[l], idx, 4), _mm256_abs_epi16(y[l]));
+    qam_llr_store_avx(qm, y, &llr[i * qm]);
+  }
+  for (; i < nb_idx; i++)
+    qam_llr_re(qm, rxF, chmag, re_idx[i], &llr[i * qm]);
+}
+
+/// ------------------------------- Hard decisions -------------------------------
+
+/// @brief Hard decision of LLR number j of a packed bit buffer (bit = 1 when the LLR is negative, LSB first)
+static inline void qam_hard_set(uint8_t *hard, uint32_t j, int16_t llr)
+{
+  if ((j & 7) == 0)
+    hard[j >> 3] = 0;
+  hard[j >> 3] |= (uint8_t)((llr < 0) << (j & 7));
+}
+
+/// @brief Packs the sign bits of n vectors of 8 LLRs into n bytes
+static inline void qam_hard_pack_sse(const __m128i *v, int n, uint8_t *hard)
+{
+  int k = 0;
+
+  for (; k + 2 <= n; k += 2)
+  {
+    uint16_t m = (uint16_t)_mm_movemask_epi8(_mm_packs_epi16(v[k], v[k + 1]));
+    memcpy(&hard[k], &m, sizeof(m));
+  }
+  if (k < n)
+    hard[k] = (uint8_t)_mm_movemask_epi8(_mm_packs_epi16(v[k], v[k]));
+}
+
+/// @brief Packs the sign bits of n vectors of 16 LLRs into 2 * n bytes
+static inline void qam_hard_pack_avx(const __m256i *v, int n, uint8_t *hard)
+{
+  int k = 0;
+
+  // packs interleaves the 128-bit lanes of its inputs, permute4x64 restores LLR order
+  for (; k + 2 <= n; k += 2)
+  {
+    uint32_t m = (uint32_t)_mm256_movemask_epi8(_mm256_permute4x64_epi64(_mm256_packs_epi16(v[k], v[k + 1]), 0xd8));
+    memcpy(&hard[2 * k], &m, sizeof(m));
+  }
+  if (k < n)
+  {
+    uint16_t m = (uint16_t)_mm256_movemask_epi8(_mm256_permute4x64_epi64(_mm256_packs_epi16(v[k], v[k]), 0xd8));
+    memcpy(&hard[2 * k], &m, sizeof(m));
+  }
+}
+
+/// @brief LLRs and packed hard decisions of nb_re contiguous REs using SSE
+///
+/// Bit j of hard (LSB first) is 1 when LLR j is negative. llr may be NULL when only
+/// the hard decisions are needed.
+static inline void qam_llr_hard_sse(int qm, const int16_t *rxF, const int16_t *const *chmag, uint32_t nb_re,
+                                    int16_t *llr, uint8_t *hard)
+{
+  __m128i y[4], v[4];
+  int16_t t[8];
+  uint32_t i = 0;
+
+  for (; i + 4 <= nb_re; i += 4)
+  {
+    y[0] = _mm_loadu_si128((const __m128i *)&rxF[2 * i]);
+    qam_llr_core_sse(qm, y, chmag, i);
+    qam_llr_interleave_sse(qm, y, v);
+    if (llr)
+      for (int k = 0; k < qm / 2; k++)
+        _mm_storeu_si128((__m128i *)&llr[i * qm + 8 * k], v[k]);
+    qam_hard_pack_sse(v, qm / 2, &hard[i * qm / 8]);
+  }
+  for (; i < nb_re; i++)
+  {
+    qam_llr_re(qm, rxF, chmag, i, llr ? &llr[i * qm] : t);
+    for (int k = 0; k < qm; k++)
+      qam_hard_set(hard, i * qm + k, llr ? llr[i * qm + k] : t[k]);
+  }
+}
+
+/// @brief LLRs and packed hard decisions of nb_re contiguous REs using AVX2
+///
+/// Same contract as qam_llr_hard_sse().
+static inline void qam_llr_hard_avx(int qm, const int16_t *rxF, const int16_t *const *chmag, uint32_t nb_re,
+                                    int16_t *llr, uint8_t *hard)
+{
+  __m256i y[4], v[4];
+  int16_t t[8];
+  uint32_t i = 0;
+
+  for (; i + 8 <= nb_re; i += 8)
+  {
+    y[0] = _mm256_loadu_si256((const __m256i *)&rxF[2 * i]);
+    qam_llr_core_avx(qm, y, chmag, i);
+    qam_llr_interleave_avx(qm, y, v);
+    if (llr)
+      for (int k = 0; k < qm / 2; k++)
+        _mm256_storeu_si256((__m256i *)&llr[i * qm + 16 * k], v[k]);
+    qam_hard_pack_avx(v, qm / 2, &hard[i * qm / 8]);
+  }
+  for (; i < nb_re; i++)
+  {
+    qam_llr_re(qm, rxF, chmag, i, llr ? &llr[i * qm] : t);
+    for (int k = 0; k < qm; k++)
+      qam_hard_set(hard, i * qm + k, llr ? llr[i * qm + k] : t[k]);
+  }
+}
+
+/// ------------------------------ Per-PRB statistics ------------------------------
+
+/// @brief Number of REs of a PRB
+#define QAM_NB_RE_PRB 12
+
+/// @brief Link-adaptation statistics of one PRB, gathered while demapping
+typedef struct
+{
+  uint32_t nb_sat;      // LLRs clipped to INT16_MIN/INT16_MAX by the saturating recursion
+  uint16_t mean_abs[8]; // mean |LLR| per bit position, qm entries used
+  uint64_t dist2;       // EVM proxy: sum over I/Q of (|y_last| - chmag_last / 2)^2
+  uint64_t ref2;        // EVM proxy reference: sum over I/Q of (chmag_last / 2)^2
+} qam_llr_prb_stats_t;
+
+/// @brief Horizontal sum of 4 int32
+static inline int32_t qam_hsum_epi32_sse(__m128i x)
+{
+  x = _mm_add_epi32(x, _mm_shuffle_epi32(x, 0x4e));
+  x = _mm_add_epi32(x, _mm_shuffle_epi32(x, 0xb1));
+  return _mm_cvtsi128_si32(x);
+}
+
+/// @brief Horizontal sum of 2 int64
+static inline int64_t qam_hsum_epi64_sse(__m128i x)
+{
+  return _mm_cvtsi128_si64(_mm_add_epi64(x, _mm_unpackhi_epi64(x, x)));
+}
+
+/// @brief Horizontal sum of 8 int32
+static inline int32_t qam_hsum_epi32_avx(__m256i x)
+{
+  return qam_hsum_epi32_sse(_mm_add_epi32(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1)));
+}
+
+/// @brief Horizontal sum of 4 int64
+static inline int64_t qam_hsum_epi64_avx(__m256i x)
+{
+  return qam_hsum_epi64_sse(_mm_add_epi64(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1)));
+}
+
+/// @brief LLRs of nb_prb PRBs and their statistics using SSE
+///
+/// The statistics come from the registers of the recursion: saturation counts
+/// compare each chmag - |x| output against the int16 limits, |LLR| is summed per
+/// bit position (I in the even lanes, Q in the odd lanes of each level) and the
+/// EVM proxy is the distance of the last level to the nearest constellation
+/// point, which sits at chmag_last / 2 after folding.
+static inline void qam_llr_stats_sse(int qm, const int16_t *rxF, const int16_t *const *chmag, uint32_t nb_prb,
+                                     int16_t *llr, qam_llr_prb_stats_t *stats)
+{
+  const int nb_chmag = QAM_NB_CHMAG(qm);
+  const __m128i lo16 = _mm_set1_epi32(0xffff), ones = _mm_set1_epi16(1);
+  const __m128i maxv = _mm_set1_epi16(INT16_MAX), minv = _mm_set1_epi16(INT16_MIN);
+  __m128i y[4], c = _mm_setzero_si128();
+
+  for (uint32_t p = 0; p < nb_prb; p++)
+  {
+    __m128i sat = _mm_setzero_si128(), dist2 = _mm_setzero_si128(), ref2 = _mm_setzero_si128();
+    __m128i sum_abs[4][2];
+
+    for (int l = 0; l <= nb_chmag; l++)
+      sum_abs[l][0] = sum_abs[l][1] = _mm_setzero_si128();
+
+    for (uint32_t re = p * QAM_NB_RE_PRB; re < (p + 1) * QAM_NB_RE_PRB; re += 4)
+    {
+      y[0] = _mm_loadu_si128((const __m128i *)&rxF[2 * re]);
+      for (int l = 0; l < nb_chmag; l++)
+      {
+        c = _mm_loadu_si128((const __m128i *)&chmag[l][2 * re]);
+        y[l + 1] = _mm_subs_epi16(c, _mm_abs_epi16(y[l]));
+        sat = _mm_sub_epi16(sat, _mm_or_si128(_mm_cmpeq_epi16(y[l + 1], maxv), _mm_cmpeq_epi16(y[l + 1], minv)));
+      }
+      for (int l = 0; l <= nb_chmag; l++)
+      {
+        __m128i a = _mm_abs_epi16(y[l]); // |INT16_MIN| reads as 32768 once zero-extended
+        sum_abs[l][0] = _mm_add_epi32(sum_abs[l][0], _mm_and_si128(a, lo16));
+        sum_abs[l][1] = _mm_add_epi32(sum_abs[l][1], _mm_srli_epi32(a, 16));
+      }
+      __m128i h = _mm_srai_epi16(c, 1);
+      __m128i d = _mm_abs_epi16(_mm_subs_epi16(_mm_abs_epi16(y[nb_chmag]), h));
+      d = _mm_madd_epi16(d, d);
+      h = _mm_madd_epi16(h, h);
+      dist2 = _mm_add_epi64(dist2, _mm_add_epi64(_mm_cvtepu32_epi64(d), _mm_cvtepu32_epi64(_mm_srli_si128(d, 8))));
+      ref2 = _mm_add_epi64(ref2, _mm_add_epi64(_mm_cvtepu32_epi64(h), _mm_cvtepu32_epi64(_mm_srli_si128(h, 8))));
+      qam_llr_store_sse(qm, y, &llr[re * qm]);
+    }
+
+    stats[p].nb_sat = qam_hsum_epi32_sse(_mm_madd_epi16(sat, ones));
+    for (int l = 0; l <= nb_chmag; l++)
+    {
+      stats[p].mean_abs[2 * l] = qam_hsum_epi32_sse(sum_abs[l][0]) / QAM_NB_RE_PRB;
+      stats[p].mean_abs[2 * l + 1] = qam_hsum_epi32_sse(sum_abs[l][1]) / QAM_NB_RE_PRB;
+    }
+    stats[p].dist2 = qam_hsum_epi64_sse(dist2);
+    stats[p].ref2 = qam_hsum_epi64_sse(ref2);
+  }
+}
+
+/// @brief LLRs of nb_prb PRBs and their statistics using AVX2
+///
+/// Same contract as qam_llr_stats_sse(). A PRB is one 8-RE vector followed by a
+/// 4-RE vector loaded with maskload, so no read crosses the end of the PRB.
+static inline void qam_llr_stats_avx(int qm, const int16_t *rxF, const int16_t *const *chmag, uint32_t nb_prb,
+                                     int16_t *llr, qam_llr_prb_stats_t *stats)
+{
+  const int nb_chmag = QAM_NB_CHMAG(qm);
+  const __m256i lo16 = _mm256_set1_epi32(0xffff), ones = _mm256_set1_epi16(1);
+  const __m256i maxv = _mm256_set1_epi16(INT16_MAX), minv = _mm256_set1_epi16(INT16_MIN);
+  const __m256i half = _mm256_setr_epi32(-1, -1, -1, -1, 0, 0, 0, 0);
+  __m256i y[4], c = _mm256_setzero_si256();
+
+  for (uint32_t p = 0; p < nb_prb; p++)
+  {
+    __m256i sat = _mm256_setzero_si256(), dist2 = _mm256_setzero_si256(), ref2 = _mm256_setzero_si256();
+    __m256i sum_abs[4][2];
+
+    for (int l = 0; l <= nb_chmag; l++)
+      sum_abs[l][0] = sum_abs[l][1] = _mm256_setzero_si256();
+
+    for (uint32_t re = p * QAM_NB_RE_PRB; re < (p + 1) * QAM_NB_RE_PRB; re += 8)
+    {
+      // second vector of the PRB only holds 4 REs, the upper lanes load as zero
+      __m256i m = (re == p * QAM_NB_RE_PRB) ? _mm256_set1_epi32(-1) : half;
+
+      y[0] = _mm256_maskload_epi32((const int *)&rxF[2 * re], m);
+      for (int l = 0; l < nb_chmag; l++)
+      {
+        c = _mm256_maskload_epi32((const int *)&chmag[l][2 * re], m);
+        y[l + 1] = _mm256_subs_epi16(c, _mm256_abs_epi16(y[l]));
+        sat = _mm256_sub_epi16(sat, _mm256_or_si256(_mm256_cmpeq_epi16(y[l + 1], maxv), _mm256_cmpeq_epi16(y[l + 1], minv)));
+      }
+      for (int l = 0; l <= nb_chmag; l++)
+      {
+        __m256i a = _mm256_abs_epi16(y[l]); // |INT16_MIN| reads as 32768 once zero-extended
+        sum_abs[l][0] = _mm256_add_epi32(sum_abs[l][0], _mm256_and_si256(a, lo16));
+        sum_abs[l][1] = _mm256_add_epi32(sum_abs[l][1], _mm256_srli_epi32(a, 16));
+      }
+      __m256i h = _mm256_srai_epi16(c, 1);
+      __m256i d = _mm256_abs_epi16(_mm256_subs_epi16(_mm256_abs_epi16(y[nb_chmag]), h));
+      d = _mm256_madd_epi16(d, d);
+      h = _mm256_madd_epi16(h, h);
+      dist2 = _mm256_add_epi64(dist2, _mm256_add_epi64(_mm256_cvtepu32_epi64(_mm256_castsi256_si128(d)),
+                                                       _mm256_cvtepu32_epi64(_mm256_extracti128_si256(d, 1))));
+      ref2 = _mm256_add_epi64(ref2, _mm256_add_epi64(_mm256_cvtepu32_epi64(_mm256_castsi256_si128(h)),
+                                                     _mm256_cvtepu32_epi64(_mm256_extracti128_si256(h, 1))));
+      if (re == p * QAM_NB_RE_PRB)
+        qam_llr_store_avx(qm, y, &llr[re * qm]);
+      else
+      {
+        __m128i y128[4];
+        for (int l = 0; l <= nb_chmag; l++)
+          y128[l] = _mm256_castsi256_si128(y[l]);
+        qam_llr_store_sse(qm, y128, &llr[re * qm]);
+      }
+    }
+
+    stats[p].nb_sat = qam_hsum_epi32_avx(_mm256_madd_epi16(sat, ones));
+    for (int l = 0; l <= nb_chmag; l++)
+    {
+      stats[p].mean_abs[2 * l] = qam_hsum_epi32_avx(sum_abs[l][0]) / QAM_NB_RE_PRB;
+      stats[p].mean_abs[2 * l + 1] = qam_hsum_epi32_avx(sum_abs[l][1]) / QAM_NB_RE_PRB;
+    }
+    stats[p].dist2 = qam_hsum_epi64_avx(dist2);
+    stats[p].ref2 = qam_hsum_epi64_avx(ref2);
+  }
+}
+
+/// ------------------------------- Mapping profiles -------------------------------
+
+/// @brief Bit labeling and LLR order of a standard, indexed by (qm - 4) / 2
+///
+/// Output LLR j of an RE is native LLR perm[j], where the native order is the NR one
+/// [I, Q, chmag1 - |I|, chmag1 - |Q|, ...], negated when sign[j] is -1 (the standard
+/// maps bit 0 to the other side of the decision boundary).
+typedef struct
+{
+  const char *name;
+  uint8_t perm[3][8];
+  int8_t sign[3][8];
+} qam_llr_profile_t;
+
+/// @brief 3GPP TS 38.211 5.1: bits alternate between I and Q, bit 0 on the positive side
+static const qam_llr_profile_t qam_profile_nr = {
+    "nr",
+    {{0, 1, 2, 3}, {0, 1, 2, 3, 4, 5}, {0, 1, 2, 3, 4, 5, 6, 7}},
+    {{1, 1, 1, 1}, {1, 1, 1, 1, 1, 1}, {1, 1, 1, 1, 1, 1, 1, 1}},
+};
+
+/// @brief 3GPP TS 36.211 7.1: same labeling as NR
+static const qam_llr_profile_t qam_profile_lte = {
+    "lte",
+    {{0, 1, 2, 3}, {0, 1, 2, 3, 4, 5}, {0, 1, 2, 3, 4, 5, 6, 7}},
+    {{1, 1, 1, 1}, {1, 1, 1, 1, 1, 1}, {1, 1, 1, 1, 1, 1, 1, 1}},
+};
+
+/// @brief IEEE 802.11 (17.3.5.8, 21.3.12.9, 27.3.12.9): first half of the bits on I, second half on Q,
+/// bit 0 on the negative side and inner points labeled 1
+static const qam_llr_profile_t qam_profile_wifi = {
+    "wifi",
+    {{0, 2, 1, 3}, {0, 2, 4, 1, 3, 5}, {0, 2, 4, 6, 1, 3, 5, 7}},
+    {{-1, -1, -1, -1}, {-1, -1, -1, -1, -1, -1}, {-1, -1, -1, -1, -1, -1, -1, -1}},
+};
+
+/// @brief Scalar negation matching _mm_subs_epi16(0, x)
+static inline int16_t qam_neg16(int16_t x)
+{
+  return qam_subs16(0, x);
+}
+
+/// @brief Reorders and negates the qm native LLRs of one RE in place
+static inline void qam_llr_profile_re(const qam_llr_profile_t *p, int qm, int16_t *llr)
+{
+  int16_t t[8];
+  const int m = (qm - 4) / 2;
+
+  memcpy(t, llr, qm * sizeof(int16_t));
+  for (int j = 0; j < qm; j++)
+    llr[j] = (p->sign[m][j] < 0) ? qam_neg16(t[p->perm[m][j]]) : t[p->perm[m][j]];
+}
+
+/// @brief True when a profile keeps the native order and signs for a modulation order
+static inline int qam_llr_profile_is_native(const qam_llr_profile_t *p, int qm)
+{
+  const int m = (qm - 4) / 2;
+
+  for (int j = 0; j < qm; j++)
+    if (p->perm[m][j] != j || p->sign[m][j] < 0)
+      return 0;
+  return 1;
+}
+
+/// @brief Scalar reference LLRs with a mapping profile
+static inline void qam_llr_profile_ref(const qam_llr_profile_t *p, int qm, const int16_t *rxF,
+                                       const int16_t *const *chmag, uint32_t nb_re, int16_t *llr)
+{
+  qam_llr_ref(qm, rxF, chmag, nb_re, llr);
+  for (uint32_t i = 0; i < nb_re; i++)
+    qam_llr_profile_re(p, qm, &llr[i * qm]);
+}
+
+/// @brief Applies a mapping profile to the recursion outputs of 4 REs (SSE)
+///
+/// Output pair k (LLRs 2k, 2k + 1 of every RE) is rebuilt from the I/Q halves of the
+/// 32-bit RE lanes of the native levels, then negated lane-wise. p and qm are
+/// meant to be compile-time constants so that the selection folds away.
+static inline void qam_llr_profile_apply_sse(const qam_llr_profile_t *p, int qm, __m128i *y)
+{
+  const int m = (qm - 4) / 2;
+  __m128i t[4];
+
+  for (int k = 0; k < qm / 2; k++)
+  {
+    int a = p->perm[m][2 * k], b = p->perm[m][2 * k + 1];
+    __m128i lo = (a & 1) ? _mm_srli_epi32(y[a >> 1], 16) : _mm_blend_epi16(y[a >> 1], _mm_setzero_si128(), 0xaa);
+    __m128i hi = (b & 1) ? _mm_blend_epi16(y[b >> 1], _mm_setzero_si128(), 0x55) : _mm_slli_epi32(y[b >> 1], 16);
+    t[k] = _mm_or_si128(lo, hi);
+  }
+  for (int k = 0; k < qm / 2; k++)
+  {
+    int ni = p->sign[m][2 * k] < 0, nq = p->sign[m][2 * k + 1] < 0;
+    __m128i neg = _mm_subs_epi16(_mm_setzero_si128(), t[k]);
+    y[k] = (ni && nq) ? neg : ni ? _mm_blend_epi16(t[k], neg, 0x55) : nq ? _mm_blend_epi16(t[k], neg, 0xaa) : t[k];
+  }
+}
+
+/// @brief Applies a mapping profile to the recursion outputs of 8 REs (AVX2)
+///
+/// Same scheme as qam_llr_profile_apply_sse().
+static inline void qam_llr_profile_apply_avx(const qam_llr_profile_t *p, int qm, __m256i *y)
+{
+  const int m = (qm - 4) / 2;
+  __m256i t[4];
+
+  for (int k = 0; k < qm / 2; k++)
+  {
+    int a = p->perm[m][2 * k], b = p->perm[m][2 * k + 1];
+    __m256i lo = (a & 1) ? _mm256_srli_epi32(y[a >> 1], 16) : _mm256_blend_epi16(y[a >> 1], _mm256_setzero_si256(), 0xaa);
+    __m256i hi = (b & 1) ? _mm256_blend_epi16(y[b >> 1], _mm256_setzero_si256(), 0x55) : _mm256_slli_epi32(y[b >> 1], 16);
+    t[k] = _mm256_or_si256(lo, hi);
+  }
+  for (int k = 0; k < qm / 2; k++)
+  {
+    int ni = p->sign[m][2 * k] < 0, nq = p->sign[m][2 * k + 1] < 0;
+    __m256i neg = _mm256_subs_epi16(_mm256_setzero_si256(), t[k]);
+    y[k] = (ni && nq) ? neg : ni ? _mm256_blend_epi16(t[k], neg, 0x55) : nq ? _mm256_blend_epi16(t[k], neg, 0xaa) : t[k];
+  }
+}
+
+/// @brief LLRs of nb_re contiguous REs in the bit order and sign convention of a profile (SSE)
+static inline void qam_llr_profile_sse(const qam_llr_profile_t *p, int qm, const int16_t *rxF,
+                                       const int16_t *const *chmag, uint32_t nb_re, int16_t *llr)
+{
+  __m128i y[4];
+  uint32_t i = 0;
+
+  for (; i + 4 <= nb_re; i += 4)
+  {
+    y[0] = _mm_loadu_si128((const __m128i *)&rxF[2 * i]);
+    qam_llr_core_sse(qm, y, chmag, i);
+    if (!qam_llr_profile_is_native(p, qm))
+      qam_llr_profile_apply_sse(p, qm, y);
+    qam_llr_store_sse(qm, y, &llr[i * qm]);
+  }
+  for (; i < nb_re; i++)
+  {
+    qam_llr_re(qm, rxF, chmag, i, &llr[i * qm]);
+    qam_llr_profile_re(p, qm, &llr[i * qm]);
+  }
+}
+
+/// @brief LLRs of nb_re contiguous REs in the bit order and sign convention of a profile (AVX2)
+static inline void qam_llr_profile_avx(const qam_llr_profile_t *p, int qm, const int16_t *rxF,
+                                       const int16_t *const *chmag, uint32_t nb_re, int16_t *llr)
+{
+  __m256i y[4];
+  uint32_t i = 0;
+
+  for (; i + 8 <= nb_re; i += 8)
+  {
+    y[0] = _mm256_loadu_si256((const __m256i *)&rxF[2 * i]);
+    qam_llr_core_avx(qm, y, chmag, i);
+    if (!qam_llr_profile_is_native(p, qm))
+      qam_llr_profile_apply_avx(p, qm, y);
+    qam_llr_store_avx(qm, y, &llr[i * qm]);
+  }
+  for (; i < nb_re; i++)
+  {
+    qam_llr_re(qm, rxF, chmag, i, &llr[i * qm]);
+    qam_llr_profile_re(p, qm, &llr[i * qm]);
+  }
+}
+
+/// ----------------------------------- Log-MAP -----------------------------------
+
+/// @brief ln(1 + exp(-x)) sampled at x = k / 8
+static const float qam_jacobian[65] = {
+    0.693147f, 0.632599f, 0.575939f, 0.523123f, 0.474077f, 0.428701f, 0.386871f, 0.348445f,
+    0.313262f, 0.281150f, 0.251929f, 0.225413f, 0.201413f, 0.179745f, 0.160224f, 0.142675f,
+    0.126928f, 0.112822f, 0.100207f, 0.088939f, 0.078890f, 0.069936f, 0.061968f, 0.054882f,
+    0.048587f, 0.042999f, 0.038041f, 0.033646f, 0.029750f, 0.026300f, 0.023245f, 0.020542f,
+    0.018150f, 0.016034f, 0.014163f, 0.012510f, 0.011048f, 0.009756f, 0.008614f, 0.007606f,
+    0.006715f, 0.005929f, 0.005234f, 0.004620f, 0.004078f, 0.003600f, 0.003178f, 0.002805f,
+    0.002476f, 0.002185f, 0.001929f, 0.001702f, 0.001502f, 0.001326f, 0.001170f, 0.001033f,
+    0.000911f, 0.000804f, 0.000710f, 0.000627f, 0.000553f, 0.000488f, 0.000431f, 0.000380f,
+    0.000335f,
+};
+
+/// @brief Quantized Jacobian correction of the log-MAP mode
+///
+/// tab[k] is ln(1 + exp(-c u)) / c in LLR output units for |u| in [k << shift, (k + 1) << shift),
+/// where c is the LLR value of one output unit (it depends on the noise variance).
+typedef struct
+{
+  int8_t tab[16];
+  int shift;
+} qam_logmap_t;
+
+/// @brief Builds the correction table for an LLR scale of llr_per_unit (natural-log LLR per output unit)
+static inline void qam_logmap_init(qam_logmap_t *lm, float llr_per_unit)
+{
+  // Smallest bucket width such that the 16 buckets cover the correction down to exp(-8)
+  lm->shift = 0;
+  while (lm->shift < 14 && (float)(16 << lm->shift) * llr_per_unit < 8.0f)
+    lm->shift++;
+  for (int k = 0; k < 16; k++)
+  {
+    float x = ((float)k + 0.5f) * (float)(1 << lm->shift) * llr_per_unit;
+    int j = (int)(x * 8.0f + 0.5f);
+    float t = (j > 64) ? 0.0f : qam_jacobian[j] / llr_per_unit;
+    lm->tab[k] = (t > 127.0f) ? 127 : (int8_t)(t + 0.5f);
+  }
+}
+
+/// @brief Scalar table lookup for |u| (taken as unsigned, so |INT16_MIN| = 32768)
+static inline int16_t qam_logmap_lookup(const qam_logmap_t *lm, uint32_t u)
+{
+  u >>= lm->shift;
+  return lm->tab[(u > 15) ? 15 : u];
+}
+
+/// @brief Adds the Jacobian correction to the qm native LLRs of one RE in place
+///
+/// Level l < last gets sign(y_l) T(|y_{l+1}|): the gap between the two nearest points
+/// of the winning bit set grows with |y_{l+1}|. The last level separates inner (+)
+/// from outer (-) points, symmetric around y_{last-1} = 0, and gets
+/// T(|y_{last-1}|) - T(3 |y_{last-1}|).
+static inline void qam_logmap_re(const qam_logmap_t *lm, int qm, int16_t *llr)
+{
+  const int last = QAM_NB_CHMAG(qm);
+  int16_t t[8];
+
+  memcpy(t, llr, qm * sizeof(int16_t));
+  for (int c = 0; c < 2; c++)
+  {
+    for (int l = 0; l < last; l++)
+    {
+      int16_t y = t[2 * l + c], corr = qam_logmap_lookup(lm, (uint16_t)qam_abs16(t[2 * l + 2 + c]));
+      llr[2 * l + c] = qam_subs16(y, (y > 0) ? -corr : (y < 0) ? corr : 0);
+    }
+    uint32_t u = (uint16_t)qam_abs16(t[2 * last - 2 + c]);
+    int16_t corr = qam_logmap_lookup(lm, u) - qam_logmap_lookup(lm, (3 * u > 0xffff) ? 0xffff : 3 * u);
+    llr[2 * last + c] = qam_subs16(t[2 * last + c], -corr);
+  }
+}
+
+/// @brief Scalar reference LLRs of the log-MAP mode
+static inline void qam_llr_logmap_ref(const qam_logmap_t *lm, int qm, const int16_t *rxF, const int16_t *const *chmag,
+                                      uint32_t nb_re, int16_t *llr)
+{
+  qam_llr_ref(qm, rxF, chmag, nb_re, llr);
+  for (uint32_t i = 0; i < nb_re; i++)
+    qam_logmap_re(lm, qm, &llr[i * qm]);
+}
+
+/// @brief Table lookup of 8 unsigned |u| with pshufb; tab holds the 16 entries
+static inline __m128i qam_logmap_lookup_sse(__m128i tab, __m128i u, int shift)
+{
+  // bit 7 of the high byte index zeroes it, so the int8 entry lands zero-extended in each int16
+  __m128i idx = _mm_min_epu16(_mm_srl_epi16(u, _mm_cvtsi32_si128(shift)), _mm_set1_epi16(15));
+  return _mm_shuffle_epi8(tab, _mm_or_si128(idx, _mm_set1_epi16((short)0x8000)));
+}
+
+/// @brief Table lookup of 16 unsigned |u| with vpshufb; tab holds the 16 entries in both lanes
+static inline __m256i qam_logmap_lookup_avx(__m256i tab, __m256i u, int shift)
+{
+  __m256i idx = _mm256_min_epu16(_mm256_srl_epi16(u, _mm_cvtsi32_si128(shift)), _mm256_set1_epi16(15));
+  return _mm256_shuffle_epi8(tab, _mm256_or_si256(idx, _mm256_set1_epi16((short)0x8000)));
+}
+
+/// @brief Adds the Jacobian correction to the recursion outputs of 4 REs (SSE)
+static inline void qam_logmap_apply_sse(__m128i tab, int shift, int qm, __m128i *y)
+{
+  const int last = QAM_NB_CHMAG(qm);
+  __m128i a[4], corr[4];
+
+  for (int l = 0; l <= last; l++)
+    a[l] = _mm_abs_epi16(y[l]);
+  for (int l = 0; l < last; l++)
+    corr[l] = _mm_sign_epi16(qam_logmap_lookup_sse(tab, a[l + 1], shift), y[l]);
+  corr[last] = _mm_sub_epi16(qam_logmap_lookup_sse(tab, a[last - 1], shift),
+                             qam_logmap_lookup_sse(tab, _mm_adds_epu16(a[last - 1], _mm_adds_epu16(a[last - 1], a[last - 1])), shift));
+  for (int l = 0; l <= last; l++)
+    y[l] = _mm_adds_epi16(y[l], corr[l]);
+}
+
+/// @brief Adds the Jacobian correction to the recursion outputs of 8 REs (AVX2)
+static inline void qam_logmap_apply_avx(__m256i tab, int shift, int qm, __m256i *y)
+{
+  const int last = QAM_NB_CHMAG(qm);
+  __m256i a[4], corr[4];
+
+  for (int l = 0; l <= last; l++)
+    a[l] = _mm256_abs_epi16(y[l]);
+  for (int l = 0; l < last; l++)
+    corr[l] = _mm256_sign_epi16(qam_logmap_lookup_avx(tab, a[l + 1], shift), y[l]);
+  corr[last] = _mm256_sub_epi16(qam_logmap_lookup_avx(tab, a[last - 1], shift),
+                                qam_logmap_lookup_avx(tab, _mm256_adds_epu16(a[last - 1], _mm256_adds_epu16(a[last - 1], a[last - 1])), shift));
+  for (int l = 0; l <= last; l++)
+    y[l] = _mm256_adds_epi16(y[l], corr[l]);
+}
+
+/// @brief Log-MAP LLRs of nb_re contiguous REs using SSE, the table stays in one register
+static inline void qam_llr_logmap_sse(const qam_logmap_t *lm, int qm, const int16_t *rxF, const int16_t *const *chmag,
+                                      uint32_t nb_re, int16_t *llr)
+{
+  const __m128i tab = _mm_loadu_si128((const __m128i *)lm->tab);
+  __m128i y[4];
+  uint32_t i = 0;
+
+  for (; i + 4 <= nb_re; i += 4)
+  {
+    y[0] = _mm_loadu_si128((const __m128i *)&rxF[2 * i]);
+    qam_llr_core_sse(qm, y, chmag, i);
+    qam_logmap_apply_sse(tab, lm->shift, qm, y);
+    qam_llr_store_sse(qm, y, &llr[i * qm]);
+  }
+  for (; i < nb_re; i++)
+  {
+    qam_llr_re(qm, rxF, chmag, i, &llr[i * qm]);
+    qam_logmap_re(lm, qm, &llr[i * qm]);
+  }
+}
+
+/// @brief Log-MAP LLRs of nb_re contiguous REs using AVX2, the table stays in one register
+static inline void qam_llr_logmap_avx(const qam_logmap_t *lm, int qm, const int16_t *rxF, const int16_t *const *chmag,
+                                      uint32_t nb_re, int16_t *llr)
+{
+  const __m256i tab = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)lm->tab));
+  __m256i y[4];
+  uint32_t i = 0;
+
+  for (; i + 8 <= nb_re; i += 8)
+  {
+    y[0] = _mm256_loadu_si256((const __m256i *)&rxF[2 * i]);
+    qam_llr_core_avx(qm, y, chmag, i);
+    qam_logmap_apply_avx(tab, lm->shift, qm, y);
+    qam_llr_store_avx(qm, y, &llr[i * qm]);
+  }
+  for (; i < nb_re; i++)
+  {
+    qam_llr_re(qm, rxF, chmag, i, &llr[i * qm]);
+    qam_logmap_re(lm, qm, &llr[i * qm]);
+  }
+}
+
+/// -------------------------------- Multi-UE batch --------------------------------
+
+#define QAM_BATCH_MAX_UE 256
+#define QAM_BATCH_MAX_RE 16384
+
+/// @brief One small allocation of a batch
+typedef struct
+{
+  const int16_t *rxF;
+  const int16_t *chmag[3];
+  uint32_t nb_re;
+  int16_t *llr;
+} qam_llr_ue_t;
+
+/// @brief Source of one 8-RE vector of the packed RE sequence
+typedef struct
+{
+  uint32_t re; // first RE within the UE
+  uint16_t ue; // UE of the first RE
+  uint8_t nb;  // REs of that UE in the vector, 8 when the vector lies inside one UE
+} qam_batch_vec_t;
+
+/// @brief Descriptor table of a batch: the REs of all UEs back to back, cut into 8-RE vectors
+typedef struct
+{
+  int qm;
+  uint32_t nb_ue;
+  uint32_t nb_re;
+  uint32_t nb_vec;
+  qam_llr_ue_t ue[QAM_BATCH_MAX_UE];
+  qam_batch_vec_t vec[QAM_BATCH_MAX_RE / 8];
+} qam_llr_batch_t;
+
+/// @brief Builds the descriptor table of nb_ue allocations of the same modulation order
+/// @return 0 on success, -1 if the batch exceeds QAM_BATCH_MAX_UE or QAM_BATCH_MAX_RE
+static inline int qam_llr_batch_init(qam_llr_batch_t *b, int qm, const qam_llr_ue_t *ue, uint32_t nb_ue)
+{
+  uint32_t u = 0, re = 0;
+
+  if (nb_ue > QAM_BATCH_MAX_UE)
+    return -1;
+  b->qm = qm;
+  b->nb_ue = nb_ue;
+  b->nb_re = 0;
+  for (uint32_t k = 0; k < nb_ue; k++)
+  {
+    b->ue[k] = ue[k];
+    b->nb_re += ue[k].nb_re;
+  }
+  if (b->nb_re > QAM_BATCH_MAX_RE)
+    return -1;
+
+  b->nb_vec = (b->nb_re + 7) / 8;
+  for (uint32_t v = 0; v < b->nb_vec; v++)
+  {
+    while (re == ue[u].nb_re)
+      u++, re = 0;
+    b->vec[v].ue = (uint16_t)u;
+    b->vec[v].re = re;
+    b->vec[v].nb = (ue[u].nb_re - re >= 8) ? 8 : (uint8_t)(ue[u].nb_re - re);
+
+    for (uint32_t left = 8; left && u < nb_ue;)
+    {
+      uint32_t n = (ue[u].nb_re - re < left) ? ue[u].nb_re - re : left;
+      re += n;
+      left -= n;
+      if (re == ue[u].nb_re)
+        u++, re = 0;
+    }
+  }
+  return 0;
+}
+
+/// @brief Copies the REs of a vector that spans several UEs into 8-RE bounce buffers, zero-padded
+static inline void qam_batch_gather(const qam_llr_batch_t *b, int qm, const qam_batch_vec_t *d, int16_t *rxF,
+                                    int16_t (*chmag)[16])
+{
+  uint32_t u = d->ue, re = d->re;
+
+  for (int k = 0; k < 8; k++, re++)
+  {
+    while (u < b->nb_ue && re == b->ue[u].nb_re)
+      u++, re = 0;
+    if (u == b->nb_ue)
+    {
+      memset(&rxF[2 * k], 0, (16 - 2 * k) * sizeof(int16_t));
+      for (int l = 0; l < QAM_NB_CHMAG(qm); l++)
+        memset(&chmag[l][2 * k], 0, (16 - 2 * k) * sizeof(int16_t));
+      return;
+    }
+    memcpy(&rxF[2 * k], &b->ue[u].rxF[2 * re], 2 * sizeof(int16_t));
+    for (int l = 0; l < QAM_NB_CHMAG(qm); l++)
+      memcpy(&chmag[l][2 * k], &b->ue[u].chmag[l][2 * re], 2 * sizeof(int16_t));
+  }
+}
+
+/// @brief Loads the REs of a vector that spans several UEs, one masked load and lane shift per UE, zero-padded
+static inline void qam_batch_gather_avx(const qam_llr_batch_t *b, int qm, const qam_batch_vec_t *d, __m256i *y,
+                                        __m256i *c)
+{
+  const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  uint32_t k = 0;
+
+  y[0] = _mm256_setzero_si256();
+  for (int l = 0; l < QAM_NB_CHMAG(qm); l++)
+    c[l] = _mm256_setzero_si256();
+  for (uint32_t u = d->ue, re = d->re; k < 8 && u < b->nb_ue; u++, re = 0)
+  {
+    const qam_llr_ue_t *ue = &b->ue[u];
+    uint32_t n = (ue->nb_re - re < 8 - k) ? ue->nb_re - re : 8 - k;
+    if (!n)
+      continue;
+    // one RE is one 32-bit lane: load the n REs into lanes 0..n-1, then move them to lanes k..k+n-1
+    __m256i ld = _mm256_cmpgt_epi32(_mm256_set1_epi32(n), lane);
+    __m256i idx = _mm256_sub_epi32(lane, _mm256_set1_epi32(k));
+    __m256i sel = _mm256_andnot_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(k), lane),
+                                      _mm256_cmpgt_epi32(_mm256_set1_epi32(k + n), lane));
+    __m256i x = _mm256_permutevar8x32_epi32(_mm256_maskload_epi32((const int *)&ue->rxF[2 * re], ld), idx);
+    y[0] = _mm256_or_si256(y[0], _mm256_and_si256(x, sel));
+    for (int l = 0; l < QAM_NB_CHMAG(qm); l++)
+    {
+      x = _mm256_permutevar8x32_epi32(_mm256_maskload_epi32((const int *)&ue->chmag[l][2 * re], ld), idx);
+      c[l] = _mm256_or_si256(c[l], _mm256_and_si256(x, sel));
+    }
+    k += n;
+  }
+}
+
+/// @brief Copies the LLRs of a vector that spans several UEs back to each UE's output
+static inline void qam_batch_scatter(const qam_llr_batch_t *b, int qm, const qam_batch_vec_t *d, const int16_t *llr)
+{
+  uint32_t u = d->ue, re = d->re;
+
+  for (int k = 0; k < 8; k++, re++)
+  {
+    while (u < b->nb_ue && re == b->ue[u].nb_re)
+      u++, re = 0;
+    if (u == b->nb_ue)
+      return;
+    memcpy(&b->ue[u].llr[qm * re], &llr[qm * k], qm * sizeof(int16_t));
+  }
+}
+
+/// @brief Scalar reference of a batch: each UE demapped on its own
+static inline void qam_llr_batch_ref(const qam_llr_batch_t *b)
+{
+  for (uint32_t u = 0; u < b->nb_ue; u++)
+    qam_llr_ref(b->qm, b->ue[u].rxF, b->ue[u].chmag, b->ue[u].nb_re, b->ue[u].llr);
+}
+
+/// @brief Demaps a batch with SSE, two 4-RE halves per descriptor
+///
+/// Vectors inside one UE load and store in place; only the few that straddle UEs or pad the
+/// end go through the bounce buffers, so no UE pays a loop setup or a scalar tail.
+/// Forced inline so that each modulation order gets its own loop with the recursion unrolled.
+static inline __attribute__((always_inline)) void qam_llr_batch_sse_qm(const qam_llr_batch_t *b, const int qm)
+{
+  int16_t rxF[16], chmag_buf[3][16], llr[64];
+  const int16_t *chmag[3] = {chmag_buf[0], chmag_buf[1], chmag_buf[2]};
+  __m128i y[4];
+
+  for (uint32_t v = 0; v < b->nb_vec; v++)
+  {
+    const qam_batch_vec_t *d = &b->vec[v];
+    const qam_llr_ue_t *ue = &b->ue[d->ue];
+    if (d->nb == 8)
+    {
+      for (uint32_t i = d->re; i < d->re + 8; i += 4)
+      {
+        y[0] = _mm_loadu_si128((const __m128i *)&ue->rxF[2 * i]);
+        qam_llr_core_sse(qm, y, ue->chmag, i);
+        qam_llr_store_sse(qm, y, &ue->llr[i * qm]);
+      }
+    }
+    else
+    {
+      qam_batch_gather(b, qm, d, rxF, chmag_buf);
+      for (uint32_t i = 0; i < 8; i += 4)
+      {
+        y[0] = _mm_loadu_si128((const __m128i *)&rxF[2 * i]);
+        qam_llr_core_sse(qm, y, chmag, i);
+        qam_llr_store_sse(qm, y, &llr[i * qm]);
+      }
+      qam_batch_scatter(b, qm, d, llr);
+    }
+  }
+}
+
+/// @brief Demaps a batch with AVX2, one descriptor per iteration
+static inline __attribute__((always_inline)) void qam_llr_batch_avx_qm(const qam_llr_batch_t *b, const int qm)
+{
+  int16_t llr[64];
+  __m256i y[4], c[3];
+
+  for (uint32_t v = 0; v < b->nb_vec; v++)
+  {
+    const qam_batch_vec_t *d = &b->vec[v];
+    const qam_llr_ue_t *ue = &b->ue[d->ue];
+    if (d->nb == 8)
+    {
+      y[0] = _mm256_loadu_si256((const __m256i *)&ue->rxF[2 * d->re]);
+      qam_llr_core_avx(qm, y, ue->chmag, d->re);
+      qam_llr_store_avx(qm, y, &ue->llr[d->re * qm]);
+    }
+    else
+    {
+      qam_batch_gather_avx(b, qm, d, y, c);
+      for (int l = 0; l < QAM_NB_CHMAG(qm); l++)
+        y[l + 1] = _mm256_subs_epi16(c[l], _mm256_abs_epi16(y[l]));
+      qam_llr_store_avx(qm, y, llr);
+      qam_batch_scatter(b, qm, d, llr);
+    }
+  }
+}
+
+/// @brief Demaps a batch with SSE; the descriptor loop is specialized per modulation order
+static inline void qam_llr_batch_sse(const qam_llr_batch_t *b)
+{
+  if (b->qm == 4)
+    qam_llr_batch_sse_qm(b, 4);
+  else if (b->qm == 6)
+    qam_llr_batch_sse_qm(b, 6);
+  else
+    qam_llr_batch_sse_qm(b, 8);
+}
+
+/// @brief Demaps a batch with AVX2; the descriptor loop is specialized per modulation order
+static inline void qam_llr_batch_avx(const qam_llr_batch_t *b)
+{
+  if (b->qm == 4)
+    qam_llr_batch_avx_qm(b, 4);
+  else if (b->qm == 6)
+    qam_llr_batch_avx_qm(b, 6);
+  else
+    qam_llr_batch_avx_qm(b, 8);
+}
+
+/// ------------------------------ QPSK and pi/2-BPSK ------------------------------
+
+static inline int16_t qam_adds16(int16_t a, int16_t b)
+{
+  int32_t s = (int32_t)a + b;
+  return (s > INT16_MAX) ? INT16_MAX : (s < INT16_MIN) ? INT16_MIN : (int16_t)s;
+}
+
+/// @brief Scalar QPSK LLRs: the compensated I and Q are the max-log LLRs of the two bits
+static inline void qpsk_llr_ref(const int16_t *rxF, uint32_t nb_re, int16_t *llr)
+{
+  for (uint32_t i = 0; i < 2 * nb_re; i++)
+    llr[i] = rxF[i];
+}
+
+/// @brief QPSK LLRs of nb_re REs using SSE
+static inline void qpsk_llr_sse(const int16_t *rxF, uint32_t nb_re, int16_t *llr)
+{
+  uint32_t i = 0;
+
+  for (; i + 4 <= nb_re; i += 4)
+    _mm_storeu_si128((__m128i *)&llr[2 * i], _mm_loadu_si128((const __m128i *)&rxF[2 * i]));
+  qpsk_llr_ref(&rxF[2 * i], nb_re - i, &llr[2 * i]);
+}
+
+/// @brief QPSK LLRs of nb_re REs using AVX2
+static inline void qpsk_llr_avx(const int16_t *rxF, uint32_t nb_re, int16_t *llr)
+{
+  uint32_t i = 0;
+
+  for (; i + 8 <= nb_re; i += 8)
+    _mm256_storeu_si256((__m256i *)&llr[2 * i], _mm256_loadu_si256((const __m256i *)&rxF[2 * i]));
+  qpsk_llr_ref(&rxF[2 * i], nb_re - i, &llr[2 * i]);
+}
+
+/// @brief Scalar pi/2-BPSK LLR of the symbol with index k in the allocation
+///
+/// 38.211 5.1.1 rotates odd symbols by j, so (I, Q) = a (1 + j) for even k and a (-1 + j) for odd k.
+/// The de-rotation is folded into the sum: I + Q for even k, Q - I for odd k.
+static inline int16_t pi2bpsk_llr_re(int16_t i, int16_t q, uint32_t k)
+{
+  return qam_adds16((k & 1) ? qam_subs16(0, i) : i, q);
+}
+
+/// @brief Scalar pi/2-BPSK LLRs, one per RE; first is the symbol index of rxF[0] in the allocation
+static inline void pi2bpsk_llr_ref(const int16_t *rxF, uint32_t first, uint32_t nb_re, int16_t *llr)
+{
+  for (uint32_t i = 0; i < nb_re; i++)
+    llr[i] = pi2bpsk_llr_re(rxF[2 * i], rxF[2 * i + 1], first + i);
+}
+
+/// @brief pi/2-BPSK LLRs of nb_re REs using SSE, 8 REs per iteration
+static inline void pi2bpsk_llr_sse(const int16_t *rxF, uint32_t first, uint32_t nb_re, int16_t *llr)
+{
+  // I of the odd symbols: int16 elements 2 and 6 of each 4-RE vector, or 0 and 4 when first is odd
+  const __m128i odd = (first & 1) ? _mm_setr_epi16(-1, 0, 0, 0, -1, 0, 0, 0) : _mm_setr_epi16(0, 0, -1, 0, 0, 0, -1, 0);
+  const __m128i zero = _mm_setzero_si128();
+  uint32_t i = 0;
+
+  for (; i + 8 <= nb_re; i += 8)
+  {
+    __m128i x0 = _mm_loadu_si128((const __m128i *)&rxF[2 * i]);
+    __m128i x1 = _mm_loadu_si128((const __m128i *)&rxF[2 * i + 8]);
+    x0 = _mm_blendv_epi8(x0, _mm_subs_epi16(zero, x0), odd);
+    x1 = _mm_blendv_epi8(x1, _mm_subs_epi16(zero, x1), odd);
+    _mm_storeu_si128((__m128i *)&llr[i], _mm_hadds_epi16(x0, x1));
+  }
+  pi2bpsk_llr_ref(&rxF[2 * i], first + i, nb_re - i, &llr[i]);
+}
+
+/// @brief pi/2-BPSK LLRs of nb_re REs using AVX2, 16 REs per iteration
+static inline void pi2bpsk_llr_avx(const int16_t *rxF, uint32_t first, uint32_t nb_re, int16_t *llr)
+{
+  const __m256i odd = (first & 1) ? _mm256_setr_epi16(-1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0)
+                                  : _mm256_setr_epi16(0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0);
+  const __m256i zero = _mm256_setzero_si256();
+  uint32_t i = 0;
+
+  for (; i + 16 <= nb_re; i += 16)
+  {
+    __m256i x0 = _mm256_loadu_si256((const __m256i *)&rxF[2 * i]);
+    __m256i x1 = _mm256_loadu_si256((const __m256i *)&rxF[2 * i + 16]);
+    x0 = _mm256_blendv_epi8(x0, _mm256_subs_epi16(zero, x0), odd);
+    x1 = _mm256_blendv_epi8(x1, _mm256_subs_epi16(zero, x1), odd);
+    // hadds works per 128-bit lane: REs {0-3, 8-11 | 4-7, 12-15}
+    __m256i s = _mm256_hadds_epi16(x0, x1);
+    _mm256_storeu_si256((__m256i *)&llr[i], _mm256_permute4x64_epi64(s, 0xd8));
+  }
+  pi2bpsk_llr_ref(&rxF[2 * i], first + i, nb_re - i, &llr[i]);
+}
+
+#ifdef __AVX512BW__
+/// @brief QPSK LLRs of nb_re REs using AVX-512
+static inline void qpsk_llr_avx512(const int16_t *rxF, uint32_t nb_re, int16_t *llr)
+{
+  uint32_t i = 0;
+
+  for (; i + 16 <= nb_re; i += 16)
+    _mm512_storeu_si512((__m512i *)&llr[2 * i], _mm512_loadu_si512((const __m512i *)&rxF[2 * i]));
+  qpsk_llr_ref(&rxF[2 * i], nb_re - i, &llr[2 * i]);
+}
+
+/// @brief pi/2-BPSK LLRs of nb_re REs using AVX-512, 16 REs per iteration
+static inline void pi2bpsk_llr_avx512(const int16_t *rxF, uint32_t first, uint32_t nb_re, int16_t *llr)
+{
+  const __mmask32 odd = (first & 1) ? 0x11111111 : 0x44444444;
+  const __m512i zero = _mm512_setzero_si512();
+  uint32_t i = 0;
+
+  for (; i + 16 <= nb_re; i += 16)
+  {
+    __m512i x = _mm512_loadu_si512((const __m512i *)&rxF[2 * i]);
+    x = _mm512_mask_subs_epi16(x, odd, zero, x);
+    // swapping I and Q within each RE puts the sum in the low half of every 32-bit lane
+    x = _mm512_adds_epi16(x, _mm512_rol_epi32(x, 16));
+    _mm256_storeu_si256((__m256i *)&llr[i], _mm512_cvtepi32_epi16(x));
+  }
+  pi2bpsk_llr_ref(&rxF[2 * i], first + i, nb_re - i, &llr[i]);
+}
+#endif
+
+/// ----------------------------- Symbol-granular slot -----------------------------
+
+#define QAM_SLOT_MAX_SYMB 14
+#define QAM_SLOT_MAX_CB 156
+
+/// @brief Called once per codeblock, in codeblock order, as soon as all its LLRs are written
+typedef void (*qam_slot_ready_t)(void *arg, uint32_t cb, const int16_t *llr, uint32_t nb_llr);
+
+/// @brief LLR buffer of one slot filled one OFDM symbol, or RE range of a symbol, at a time
+///
+/// The LLRs of symbol l start after those of symbols 0 .. l-1, and codeblock r covers E_r LLRs
+/// after codeblocks 0 .. r-1 (TS 38.212 5.4.2.1, one layer). A slot is filled by one thread.
+typedef struct
+{
+  int qm;
+  uint32_t nb_symb;
+  uint32_t nb_cb;
+  uint32_t nb_cb_ready;                      // codeblocks signalled so far
+  uint32_t nb_symb_ready;                    // symbols 0 .. nb_symb_ready-1 are complete
+  uint32_t ready;                            // LLRs [0, ready) are written
+  uint32_t symb_re[QAM_SLOT_MAX_SYMB];       // data REs of each symbol
+  uint32_t symb_llr[QAM_SLOT_MAX_SYMB + 1];  // first LLR of each symbol
+  uint32_t symb_prefix[QAM_SLOT_MAX_SYMB];   // REs done from the start of the symbol without a gap
+  uint32_t symb_done[QAM_SLOT_MAX_SYMB];     // REs done in total
+  uint32_t cb_llr[QAM_SLOT_MAX_CB + 1];      // first LLR of each codeblock
+  int16_t *llr;
+  qam_slot_ready_t ready_fn;
+  void *arg;
+} qam_llr_slot_t;
+
+/// @brief Clears the progress of a slot to reuse its layout for the next one
+static inline void qam_llr_slot_reset(qam_llr_slot_t *s)
+{
+  s->nb_cb_ready = 0;
+  s->nb_symb_ready = 0;
+  s->ready = 0;
+  memset(s->symb_prefix, 0, sizeof(s->symb_prefix));
+  memset(s->symb_done, 0, sizeof(s->symb_done));
+}
+
+/// @brief Lays out a slot of nb_symb symbols with symb_re[l] data REs each, split into nb_cb codeblocks
+/// @return 0 on success, -1 if the layout exceeds the limits or a codeblock would be empty
+static inline int qam_llr_slot_init(qam_llr_slot_t *s, int qm, const uint32_t *symb_re, uint32_t nb_symb,
+                                    uint32_t nb_cb, int16_t *llr, qam_slot_ready_t ready_fn, void *arg)
+{
+  uint32_t nb_re = 0;
+
+  if (nb_symb > QAM_SLOT_MAX_SYMB || nb_cb < 1 || nb_cb > QAM_SLOT_MAX_CB)
+    return -1;
+  s->qm = qm;
+  s->nb_symb = nb_symb;
+  s->nb_cb = nb_cb;
+  s->llr = llr;
+  s->ready_fn = ready_fn;
+  s->arg = arg;
+  for (uint32_t l = 0; l < nb_symb; l++)
+  {
+    s->symb_re[l] = symb_re[l];
+    s->symb_llr[l] = nb_re * qm;
+    nb_re += symb_re[l];
+  }
+  s->symb_llr[nb_symb] = nb_re * qm;
+  if (nb_re < nb_cb)
+    return -1;
+
+  // the first C - (G' mod C) codeblocks get floor(G' / C) REs, the others one more
+  s->cb_llr[0] = 0;
+  for (uint32_t r = 0; r < nb_cb; r++)
+    s->cb_llr[r + 1] = s->cb_llr[r] + qm * (nb_re / nb_cb + (r >= nb_cb - nb_re % nb_cb));
+  qam_llr_slot_reset(s);
+  return 0;
+}
+
+/// @brief Accounts for REs [re0, re0 + nb_re) of symbol l and signals the codeblocks they complete
+/// @return number of codeblocks signalled, -1 if the range lies outside the symbol
+static inline int qam_llr_slot_commit(qam_llr_slot_t *s, uint32_t l, uint32_t re0, uint32_t nb_re)
+{
+  int nb = 0;
+
+  if (l >= s->nb_symb || re0 > s->symb_re[l] || nb_re > s->symb_re[l] - re0)
+    return -1;
+  s->symb_done[l] += nb_re;
+  if (re0 == s->symb_prefix[l])
+    s->symb_prefix[l] += nb_re;
+  // ranges that arrived ahead of a gap count once the whole symbol is done
+  if (s->symb_done[l] >= s->symb_re[l])
+    s->symb_prefix[l] = s->symb_re[l];
+
+  while (s->nb_symb_ready < s->nb_symb && s->symb_prefix[s->nb_symb_ready] == s->symb_re[s->nb_symb_ready])
+    s->nb_symb_ready++;
+  s->ready = s->symb_llr[s->nb_symb_ready];
+  if (s->nb_symb_ready < s->nb_symb)
+    s->ready += s->symb_prefix[s->nb_symb_ready] * s->qm;
+
+  for (; s->nb_cb_ready < s->nb_cb && s->cb_llr[s->nb_cb_ready + 1] <= s->ready; s->nb_cb_ready++, nb++)
+    if (s->ready_fn)
+      s->ready_fn(s->arg, s->nb_cb_ready, &s->llr[s->cb_llr[s->nb_cb_ready]],
+                  s->cb_llr[s->nb_cb_ready + 1] - s->cb_llr[s->nb_cb_ready]);
+  return nb;
+}
+
+/// @brief Demaps REs [re0, re0 + nb_re) of symbol l into the slot using SSE, rxF and chmag start at re0
+/// @return number of codeblocks signalled, -1 if the range lies outside the symbol
+static inline int qam_llr_slot_sse(qam_llr_slot_t *s, uint32_t l, uint32_t re0, const int16_t *rxF,
+                                   const int16_t *const *chmag, uint32_t nb_re)
+{
+  if (l >= s->nb_symb || re0 > s->symb_re[l] || nb_re > s->symb_re[l] - re0)
+    return -1;
+  qam_llr_sse(s->qm, rxF, chmag, nb_re, &s->llr[s->symb_llr[l] + re0 * s->qm]);
+  return qam_llr_slot_commit(s, l, re0, nb_re);
+}
+
+/// @brief Demaps REs [re0, re0 + nb_re) of symbol l into the slot using AVX2, rxF and chmag start at re0
+/// @return number of codeblocks signalled, -1 if the range lies outside the symbol
+static inline int qam_llr_slot_avx(qam_llr_slot_t *s, uint32_t l, uint32_t re0, const int16_t *rxF,
+                                   const int16_t *const *chmag, uint32_t nb_re)
+{
+  if (l >= s->nb_symb || re0 > s->symb_re[l] || nb_re > s->symb_re[l] - re0)
+    return -1;
+  qam_llr_avx(s->qm, rxF, chmag, nb_re, &s->llr[s->symb_llr[l] + re0 * s->qm]);
+  return qam_llr_slot_commit(s, l, re0, nb_re);
+}
+
+/// ------------------------- Int8 input (QPSK, 16-QAM) -------------------------
+///
+/// After AGC, 8 bits cover the dynamic range of QPSK and 16-QAM. rxF and chmag then hold int8
+/// (I, Q) pairs and the LLRs are int8, in the same order as the int16 kernels. A vector
+/// carries twice the REs of the int16 kernels: 8 per SSE vector, 16 per AVX2 vector.
+///
+/// The kernels expect samples in [-127, 127], as qam_pack8_avx() produces them: |INT8_MIN| does
+/// not fit in int8, and c - |-128| would saturate to +127, a confident LLR of the wrong sign.
+
+/// @brief Scalar equivalent of _mm_abs_epi8 (INT8_MIN stays INT8_MIN)
+static inline int8_t qam_abs8(int8_t x)
+{
+  return (x == INT8_MIN) ? INT8_MIN : (int8_t)(x < 0 ? -x : x);
+}
+
+/// @brief Scalar equivalent of _mm_subs_epi8
+static inline int8_t qam_subs8(int8_t a, int8_t b)
+{
+  int32_t d = (int32_t)a - (int32_t)b;
+  return (int8_t)((d > INT8_MAX) ? INT8_MAX : (d < INT8_MIN) ? INT8_MIN : d);
+}
+
+/// @brief Scalar int16 to int8 conversion: arithmetic shift right, then symmetric saturation to [-127, 127]
+static inline void qam_pack8_ref(const int16_t *x, int shift, uint32_t n, int8_t *out)
+{
+  for (uint32_t i = 0; i < n; i++)
+  {
+    int32_t v = x[i] >> shift;
+    out[i] = (int8_t)((v > INT8_MAX) ? INT8_MAX : (v < -INT8_MAX) ? -INT8_MAX : v);
+  }
+}
+
+/// @brief int16 to int8 conversion of n values using AVX2, see qam_pack8_ref()
+static inline void qam_pack8_avx(const int16_t *x, int shift, uint32_t n, int8_t *out)
+{
+  __m128i sh = _mm_cvtsi32_si128(shift);
+  __m256i lo = _mm256_set1_epi8(-INT8_MAX);
+  uint32_t i = 0;
+
+  for (; i + 32 <= n; i += 32)
+  {
+    __m256i a = _mm256_sra_epi16(_mm256_loadu_si256((const __m256i *)&x[i]), sh);
+    __m256i b = _mm256_sra_epi16(_mm256_loadu_si256((const __m256i *)&x[i + 16]), sh);
+    // packs works per 128-bit lane, the permute restores the order; the max keeps -128 out
+    __m256i p = _mm256_max_epi8(_mm256_packs_epi16(a, b), lo);
+    _mm256_storeu_si256((__m256i *)&out[i], _mm256_permute4x64_epi64(p, 0xd8));
+  }
+  qam_pack8_ref(&x[i], shift, n - i, &out[i]);
+}
+
+/// @brief Scalar QPSK LLRs from int8 input
+static inline void qpsk_llr8_ref(const int8_t *rxF, uint32_t nb_re, int8_t *llr)
+{
+  for (uint32_t i = 0; i < 2 * nb_re; i++)
+    llr[i] = rxF[i];
+}
+
+/// @brief QPSK LLRs of nb_re REs from int8 input using SSE
+static inline void qpsk_llr8_sse(const int8_t *rxF, uint32_t nb_re, int8_t *llr)
+{
+  uint32_t i = 0;
+
+  for (; i + 8 <= nb_re; i += 8)
+    _mm_storeu_si128((__m128i *)&llr[2 * i], _mm_loadu_si128((const __m128i *)&rxF[2 * i]));
+  qpsk_llr8_ref(&rxF[2 * i], nb_re - i, &llr[2 * i]);
+}
+
+/// @brief QPSK LLRs of nb_re REs from int8 input using AVX2
+static inline void qpsk_llr8_avx(const int8_t *rxF, uint32_t nb_re, int8_t *llr)
+{
+  uint32_t i = 0;
+
+  for (; i + 16 <= nb_re; i += 16)
+    _mm256_storeu_si256((__m256i *)&llr[2 * i], _mm256_loadu_si256((const __m256i *)&rxF[2 * i]));
+  qpsk_llr8_ref(&rxF[2 * i], nb_re - i, &llr[2 * i]);
+}
+
+/// @brief Scalar 16-QAM LLRs from int8 input, bit-exact with the SIMD kernels
+static inline void qam16_llr8_ref(const int8_t *rxF, const int8_t *chmag, uint32_t nb_re, int8_t *llr)
+{
+  for (uint32_t i = 0; i < 2 * nb_re; i += 2, llr += 4)
+  {
+    llr[0] = rxF[i];
+    llr[1] = rxF[i + 1];
+    llr[2] = qam_subs8(chmag[i], qam_abs8(rxF[i]));
+    llr[3] = qam_subs8(chmag[i + 1], qam_abs8(rxF[i + 1]));
+  }
+}
+
+/// @brief 16-QAM LLRs of nb_re REs from int8 input using SSE, 8 REs per vector
+static inline void qam16_llr8_sse(const int8_t *rxF, const int8_t *chmag, uint32_t nb_re, int8_t *llr)
+{
+  uint32_t i = 0;
+
+  for (; i + 8 <= nb_re; i += 8)
+  {
+    __m128i y0 = _mm_loadu_si128((const __m128i *)&rxF[2 * i]);
+    __m128i y1 = _mm_subs_epi8(_mm_loadu_si128((const __m128i *)&chmag[2 * i]), _mm_abs_epi8(y0));
+    // an (I, Q) pair is 16 bits: interleaving pairs gives [I, Q, c - |I|, c - |Q|] per RE
+    _mm_storeu_si128((__m128i *)&llr[4 * i], _mm_unpacklo_epi16(y0, y1));
+    _mm_storeu_si128((__m128i *)&llr[4 * i + 16], _mm_unpackhi_epi16(y0, y1));
+  }
+  qam16_llr8_ref(&rxF[2 * i], &chmag[2 * i], nb_re - i, &llr[4 * i]);
+}
+
+/// @brief 16-QAM LLRs of nb_re REs from int8 input using AVX2, 16 REs per vector
+static inline void qam16_llr8_avx(const int8_t *rxF, const int8_t *chmag, uint32_t nb_re, int8_t *llr)
+{
+  uint32_t i = 0;
+
+  for (; i + 16 <= nb_re; i += 16)
+  {
+    __m256i y0 = _mm256_loadu_si256((const __m256i *)&rxF[2 * i]);
+    __m256i y1 = _mm256_subs_epi8(_mm256_loadu_si256((const __m256i *)&chmag[2 * i]), _mm256_abs_epi8(y0));
+    // unpack works per 128-bit lane: lo = REs {0-3 | 8-11}, hi = REs {4-7 | 12-15}
+    __m256i lo = _mm256_unpacklo_epi16(y0, y1), hi = _mm256_unpackhi_epi16(y0, y1);
+    _mm256_storeu_si256((__m256i *)&llr[4 * i], _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256((__m256i *)&llr[4 * i + 32], _mm256_permute2x128_si256(lo, hi, 0x31));
+  }
+  qam16_llr8_ref(&rxF[2 * i], &chmag[2 * i], nb_re - i, &llr[4 * i]);
+}
+
+#endif
@@ -0,0 +1,264 @@
+/// @brief Reduced-search max-log ML soft demapper for 2-layer spatial multiplexing, 16/64-QAM
+///
+/// y = H x + n with 2 receive antennas and 2 layers. Full ML visits all M^2 pairs (x0, x1). For
+/// each pass, this detector enumerates the M points s of one layer p and slices the other layer q:
+/// once s is fixed, |y - h_p s - h_q x|^2 is |h_q|^2 |z - x|^2 plus terms free of x, with
+/// z = h_q^H (y - h_p s) / |h_q|^2, so the best x is the per-dimension PAM slice of z. The
+/// metrics of the pass give the exact max-log LLRs of layer p, and the second pass with the
+/// layers swapped gives those of layer q: exact max-log ML at 2 M candidates instead of M^2.
+///
+/// Inputs are int16 (I, Q) pairs per RE like rxF. h[a][l] is the channel from layer l to
+/// antenna a, in units of y per unit of constellation amplitude, so the transmitted points are
+/// the odd integers of the PAM on each dimension. The metrics are computed in float.
+/// LLRs use the bit order and sign of qam_llr_ref() (positive for bit 0) and are
+/// scale * (min metric of bit 1 - min metric of bit 0), saturated to int16. For max-log LLRs,
+/// scale is 1 / noise variance times the fixed-point gain of the decoder input.
+///
+
+#ifndef QAM_MIMO_H
+#define QAM_MIMO_H
+
+#include <float.h>
+#include <stdint.h>
+
+#include "qam-llr.h"
+
+/// @brief Received samples and channel of nb_re REs of 2x2 spatial multiplexing
+typedef struct
+{
+  const int16_t *y[2];    // receive antenna a
+  const int16_t *h[2][2]; // h[a][l]: layer l to antenna a
+} qam_mimo2_t;
+
+/// @brief Rounds and saturates a float LLR to int16
+static inline int16_t qam_mimo2_sat(float x)
+{
+  if (x >= INT16_MAX)
+    return INT16_MAX;
+  if (x <= INT16_MIN)
+    return INT16_MIN;
+  return (int16_t)((x >= 0) ? (int32_t)(x + 0.5f) : -(int32_t)(-x + 0.5f));
+}
+
+/// @brief Bit j of the PAM level v on one dimension: bit 0 is the sign, then the chmag - |x| recursion
+static inline int qam_mimo2_bit(int m, int v, int j)
+{
+  int u = v;
+  for (int k = 1, t = m / 2; k <= j; k++, t /= 2)
+    u = t - ((u < 0) ? -u : u);
+  return u < 0;
+}
+
+/// @brief Nearest odd integer of [-(m - 1), m - 1]
+static inline float qam_mimo2_slice(int m, float z)
+{
+  z = (z < -m) ? (float)-m : (z > m) ? (float)m : z;
+  int k = (int)(z * 0.5f + (float)m) - m; // floor(z / 2), positive before the truncation
+  k = (k < -m / 2) ? -m / 2 : (k > m / 2 - 1) ? m / 2 - 1 : k;
+  return (float)(2 * k + 1);
+}
+
+/// @brief Scalar reference: exhaustive max-log ML over all M^2 pairs, in double
+static inline void qam_mimo2_llr_ref(int qm, const qam_mimo2_t *in, uint32_t nb_re, float scale, int16_t *const llr[2])
+{
+  int m = 1 << (qm / 2), nb = qm / 2;
+
+  for (uint32_t i = 0; i < nb_re; i++)
+  {
+    double min[2][8][2];
+    for (int l = 0; l < 2; l++)
+      for (int b = 0; b < qm; b++)
+        min[l][b][0] = min[l][b][1] = DBL_MAX;
+
+    for (int p0 = 0; p0 < m * m; p0++)
+      for (int p1 = 0; p1 < m * m; p1++)
+      {
+        int v[2][2] = {{2 * (p0 % m) - (m - 1), 2 * (p0 / m) - (m - 1)}, {2 * (p1 % m) - (m - 1), 2 * (p1 / m) - (m - 1)}};
+        double d = 0;
+        for (int a = 0; a < 2; a++)
+        {
+          double er = in->y[a][2 * i], ei = in->y[a][2 * i + 1];
+          for (int l = 0; l < 2; l++)
+          {
+            double hr = in->h[a][l][2 * i], hi = in->h[a][l][2 * i + 1];
+            er -= hr * v[l][0] - hi * v[l][1];
+            ei -= hr * v[l][1] + hi * v[l][0];
+          }
+          d += er * er + ei * ei;
+        }
+        for (int l = 0; l < 2; l++)
+          for (int j = 0; j < nb; j++)
+            for (int c = 0; c < 2; c++)
+            {
+              double *mb = &min[l][2 * j + c][qam_mimo2_bit(m, v[l][c], j)];
+              *mb = (d < *mb) ? d : *mb;
+            }
+      }
+    for (int l = 0; l < 2; l++)
+      for (int b = 0; b < qm; b++)
+        llr[l][i * qm + b] = qam_mimo2_sat((float)(scale * (min[l][b][1] - min[l][b][0])));
+  }
+}
+
+/// @brief Reduced search of one RE: layer p enumerated, the other sliced; writes the qm LLRs of layer p
+static inline void qam_mimo2_re(int qm, const qam_mimo2_t *in, uint32_t i, int p, float scale, int16_t *llr)
+{
+  int m = 1 << (qm / 2), nb = qm / 2, q = 1 - p;
+  float np = 0, nq = 0, ar = 0, ai = 0, br = 0, bi = 0, cr = 0, ci = 0;
+
+  for (int a = 0; a < 2; a++)
+  {
+    float yr = in->y[a][2 * i], yi = in->y[a][2 * i + 1];
+    float pr = in->h[a][p][2 * i], pi = in->h[a][p][2 * i + 1];
+    float qr = in->h[a][q][2 * i], qi = in->h[a][q][2 * i + 1];
+    np += pr * pr + pi * pi;
+    nq += qr * qr + qi * qi;
+    ar += pr * yr + pi * yi, ai += pr * yi - pi * yr; // h_p^H y
+    br += qr * yr + qi * yi, bi += qr * yi - qi * yr; // h_q^H y
+    cr += qr * pr + qi * pi, ci += qr * pi - qi * pr; // h_q^H h_p
+  }
+  float inq = 1.0f / ((nq > FLT_MIN) ? nq : FLT_MIN);
+  float zyr = br * inq, zyi = bi * inq, cnr = cr * inq, cni = ci * inq;
+  float rowmin[8], colmin[8];
+
+  for (int k = 0; k < m; k++)
+    colmin[k] = FLT_MAX;
+  for (int kI = 0; kI < m; kI++)
+  {
+    float sI = (float)(2 * kI - (m - 1));
+    rowmin[kI] = FLT_MAX;
+    for (int kQ = 0; kQ < m; kQ++)
+    {
+      float sQ = (float)(2 * kQ - (m - 1));
+      float zr = zyr - (cnr * sI - cni * sQ), zi = zyi - (cnr * sQ + cni * sI);
+      float xr = qam_mimo2_slice(m, zr), xi = qam_mimo2_slice(m, zi);
+      float d = np * (sI * sI + sQ * sQ) - 2.0f * (ar * sI + ai * sQ) +
+                nq * ((xr * xr + xi * xi) - 2.0f * (zr * xr + zi * xi));
+      rowmin[kI] = (d < rowmin[kI]) ? d : rowmin[kI];
+      colmin[kQ] = (d < colmin[kQ]) ? d : colmin[kQ];
+    }
+  }
+  for (int j = 0; j < nb; j++)
+  {
+    float mI[2] = {FLT_MAX, FLT_MAX}, mQ[2] = {FLT_MAX, FLT_MAX};
+    for (int k = 0; k < m; k++)
+    {
+      int b = qam_mimo2_bit(m, 2 * k - (m - 1), j);
+      mI[b] = (rowmin[k] < mI[b]) ? rowmin[k] : mI[b];
+      mQ[b] = (colmin[k] < mQ[b]) ? colmin[k] : mQ[b];
+    }
+    llr[2 * j] = qam_mimo2_sat(scale * (mI[1] - mI[0]));
+    llr[2 * j + 1] = qam_mimo2_sat(scale * (mQ[1] - mQ[0]));
+  }
+}
+
+/// @brief Splits 8 (I, Q) int16 pairs into I and Q floats
+static inline void qam_mimo2_load_avx(const int16_t *x, __m256 *re, __m256 *im)
+{
+  __m256i v = _mm256_loadu_si256((const __m256i *)x);
+  *re = _mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(v, 16), 16));
+  *im = _mm256_cvtepi32_ps(_mm256_srai_epi32(v, 16));
+}
+
+/// @brief Saturates and rounds I and Q LLRs of 8 REs back into (I, Q) int16 pairs
+static inline __m256i qam_mimo2_pack_avx(__m256 lI, __m256 lQ)
+{
+  const __m256 hi = _mm256_set1_ps(INT16_MAX), lo = _mm256_set1_ps(INT16_MIN);
+  __m256i i = _mm256_cvtps_epi32(_mm256_max_ps(_mm256_min_ps(lI, hi), lo));
+  __m256i q = _mm256_cvtps_epi32(_mm256_max_ps(_mm256_min_ps(lQ, hi), lo));
+  return _mm256_or_si256(_mm256_and_si256(i, _mm256_set1_epi32(0xffff)), _mm256_slli_epi32(q, 16));
+}
+
+/// @brief Reduced search of 8 REs using AVX2: layer p enumerated, the other sliced
+static inline void qam_mimo2_pass_avx(int qm, const qam_mimo2_t *in, uint32_t i, int p, float scale, int16_t *llr)
+{
+  const int m = 1 << (qm / 2), nb = qm / 2, q = 1 - p;
+  const __m256 two = _mm256_set1_ps(2.0f), half = _mm256_set1_ps(0.5f);
+  const __m256 kmin = _mm256_set1_ps((float)(-m / 2)), kmax = _mm256_set1_ps((float)(m / 2 - 1));
+  const __m256 big = _mm256_set1_ps(FLT_MAX);
+  __m256 np = _mm256_setzero_ps(), nq = np, ar = np, ai = np, br = np, bi = np, cr = np, ci = np;
+  __m256 rowmin[8], colmin[8];
+  __m256i y[4];
+
+  for (int a = 0; a < 2; a++)
+  {
+    __m256 yr, yi, pr, pi, qr, qi;
+    qam_mimo2_load_avx(&in->y[a][2 * i], &yr, &yi);
+    qam_mimo2_load_avx(&in->h[a][p][2 * i], &pr, &pi);
+    qam_mimo2_load_avx(&in->h[a][q][2 * i], &qr, &qi);
+    np = _mm256_add_ps(np, _mm256_add_ps(_mm256_mul_ps(pr, pr), _mm256_mul_ps(pi, pi)));
+    nq = _mm256_add_ps(nq, _mm256_add_ps(_mm256_mul_ps(qr, qr), _mm256_mul_ps(qi, qi)));
+    ar = _mm256_add_ps(ar, _mm256_add_ps(_mm256_mul_ps(pr, yr), _mm256_mul_ps(pi, yi)));
+    ai = _mm256_add_ps(ai, _mm256_sub_ps(_mm256_mul_ps(pr, yi), _mm256_mul_ps(pi, yr)));
+    br = _mm256_add_ps(br, _mm256_add_ps(_mm256_mul_ps(qr, yr), _mm256_mul_ps(qi, yi)));
+    bi = _mm256_add_ps(bi, _mm256_sub_ps(_mm256_mul_ps(qr, yi), _mm256_mul_ps(qi, yr)));
+    cr = _mm256_add_ps(cr, _mm256_add_ps(_mm256_mul_ps(qr, pr), _mm256_mul_ps(qi, pi)));
+    ci = _mm256_add_ps(ci, _mm256_sub_ps(_mm256_mul_ps(qr, pi), _mm256_mul_ps(qi, pr)));
+  }
+  __m256 inq = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_max_ps(nq, _mm256_set1_ps(FLT_MIN)));
+  __m256 zyr = _mm256_mul_ps(br, inq), zyi = _mm256_mul_ps(bi, inq);
+  __m256 cnr = _mm256_mul_ps(cr, inq), cni = _mm256_mul_ps(ci, inq);
+
+  for (int k = 0; k < m; k++)
+    colmin[k] = big;
+  for (int kI = 0; kI < m; kI++)
+  {
+    __m256 sI = _mm256_set1_ps((float)(2 * kI - (m - 1)));
+    // the parts of z and of the metric that only depend on sI
+    __m256 zr0 = _mm256_sub_ps(zyr, _mm256_mul_ps(cnr, sI)), zi0 = _mm256_sub_ps(zyi, _mm256_mul_ps(cni, sI));
+    __m256 d0 = _mm256_sub_ps(_mm256_mul_ps(np, _mm256_mul_ps(sI, sI)), _mm256_mul_ps(two, _mm256_mul_ps(ar, sI)));
+    rowmin[kI] = big;
+    for (int kQ = 0; kQ < m; kQ++)
+    {
+      __m256 sQ = _mm256_set1_ps((float)(2 * kQ - (m - 1)));
+      __m256 zr = _mm256_add_ps(zr0, _mm256_mul_ps(cni, sQ)), zi = _mm256_sub_ps(zi0, _mm256_mul_ps(cnr, sQ));
+      // slice: 2 * clamp(floor(z / 2)) + 1
+      __m256 xr = _mm256_floor_ps(_mm256_mul_ps(zr, half)), xi = _mm256_floor_ps(_mm256_mul_ps(zi, half));
+      xr = _mm256_add_ps(_mm256_mul_ps(two, _mm256_max_ps(_mm256_min_ps(xr, kmax), kmin)), _mm256_set1_ps(1.0f));
+      xi = _mm256_add_ps(_mm256_mul_ps(two, _mm256_max_ps(_mm256_min_ps(xi, kmax), kmin)), _mm256_set1_ps(1.0f));
+      __m256 e = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(xr, xr), _mm256_mul_ps(xi, xi)),
+                               _mm256_mul_ps(two, _mm256_add_ps(_mm256_mul_ps(zr, xr), _mm256_mul_ps(zi, xi))));
+      __m256 d = _mm256_add_ps(d0, _mm256_sub_ps(_mm256_mul_ps(np, _mm256_mul_ps(sQ, sQ)),
+                                                 _mm256_mul_ps(two, _mm256_mul_ps(ai, sQ))));
+      d = _mm256_add_ps(d, _mm256_mul_ps(nq, e));
+      rowmin[kI] = _mm256_min_ps(rowmin[kI], d);
+      colmin[kQ] = _mm256_min_ps(colmin[kQ], d);
+    }
+  }
+  for (int j = 0; j < nb; j++)
+  {
+    __m256 mI[2] = {big, big}, mQ[2] = {big, big};
+    for (int k = 0; k < m; k++)
+    {
+      int b = qam_mimo2_bit(m, 2 * k - (m - 1), j);
+      mI[b] = _mm256_min_ps(mI[b], rowmin[k]);
+      mQ[b] = _mm256_min_ps(mQ[b], colmin[k]);
+    }
+    __m256 s = _mm256_set1_ps(scale);
+    y[j] = qam_mimo2_pack_avx(_mm256_mul_ps(s, _mm256_sub_ps(mI[1], mI[0])), _mm256_mul_ps(s, _mm256_sub_ps(mQ[1], mQ[0])));
+  }
+  qam_llr_store_avx(qm, y, llr);
+}
+
+/// @brief Max-log ML LLRs of both layers using AVX2, 8 REs per pass; qm is 4 or 6
+static inline void qam_mimo2_llr_avx(int qm, const qam_mimo2_t *in, uint32_t nb_re, float scale, int16_t *const llr[2])
+{
+  uint32_t i = 0;
+
+  for (; i + 8 <= nb_re; i += 8)
+    for (int p = 0; p < 2; p++)
+      qam_mimo2_pass_avx(qm, in, i, p, scale, &llr[p][i * qm]);
+  for (; i < nb_re; i++)
+    for (int p = 0; p < 2; p++)
+      qam_mimo2_re(qm, in, i, p, scale, &llr[p][i * qm]);
+}
+
+/// @brief Max-log ML LLRs of both layers, scalar reduced search; qm is 4 or 6
+static inline void qam_mimo2_llr(int qm, const qam_mimo2_t *in, uint32_t nb_re, float scale, int16_t *const llr[2])
+{
+  for (uint32_t i = 0; i < nb_re; i++)
+    for (int p = 0; p < 2; p++)
+      qam_mimo2_re(qm, in, i, p, scale, &llr[p][i * qm]);
+}
+
+#endif
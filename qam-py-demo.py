@@ -0,0 +1,113 @@
+"""Checks and times the Python binding (qam-py.c) against the scalar reference and plain Python.
+
+Usage: python3 qam-py-demo.py [nb_re]    (build qam_llr first, see qam-py.c)
+
+Runs with NumPy if it is installed, else with array('h'): both export int16 buffers that the
+binding reads and writes in place.
+"""
+
+import array
+import random
+import sys
+import threading
+import time
+
+import qam_llr
+
+try:
+    import numpy as np
+except ImportError:
+    np = None
+
+
+def int16(n, values=None):
+    if np is not None:
+        return np.array(values, dtype=np.int16) if values is not None else np.zeros(n, dtype=np.int16)
+    return array.array("h", values if values is not None else bytes(2 * n))
+
+
+def same(a, b):
+    return memoryview(a).tobytes() == memoryview(b).tobytes()
+
+
+def sat16(x):
+    return max(-32768, min(32767, x))
+
+
+def llr_python(qm, rxF, chmag, nb_re):
+    """Max-log demapper as prototyped in plain Python, bit-exact with qam_llr_re()"""
+    out = []
+    for re in range(nb_re):
+        y = [rxF[2 * re], rxF[2 * re + 1]]
+        out += y
+        for l in range(qm // 2 - 1):
+            y = [sat16(chmag[l][2 * re + c] - min(abs(y[c]), 32767)) for c in range(2)]
+            out += y
+    return out
+
+
+def main():
+    nb_re = int(sys.argv[1]) if len(sys.argv) > 1 else 100003  # odd, so that the kernel tails run
+    rng = random.Random(1)
+    s = e = 0
+
+    rxF = int16(2 * nb_re, [rng.randint(-32768, 32767) for _ in range(2 * nb_re)])
+    chmag = [int16(2 * nb_re, [rng.randint(0, 16384 >> l) for _ in range(2 * nb_re)]) for l in range(3)]
+    print("qam_llr %s kernel, %s buffers" % (qam_llr.isa, "numpy" if np is not None else "array('h')"))
+
+    for qm in (4, 6, 8):
+        ref = int16(qm * nb_re)
+        qam_llr.llr_ref(qm, rxF, chmag, ref)
+
+        # plain Python on the first REs only, it is orders of magnitude slower
+        nb_py = min(nb_re, 2000)
+        t = time.perf_counter()
+        py = llr_python(qm, rxF, chmag, nb_py)
+        dt_py = (time.perf_counter() - t) / nb_py
+        ok = list(py) == list(ref[: qm * nb_py])
+
+        for threads in (1, 2, 4, 0):
+            out = int16(qm * nb_re)
+            ok &= qam_llr.llr(qm, rxF, chmag, out, threads=threads) is out and same(out, ref)
+
+        # GIL released: Python threads demap their own buffers concurrently
+        outs = [int16(qm * nb_re) for _ in range(4)]
+        workers = [threading.Thread(target=qam_llr.llr, args=(qm, rxF, chmag, o, 1)) for o in outs]
+        for w in workers:
+            w.start()
+        for w in workers:
+            w.join()
+        ok &= all(same(o, ref) for o in outs)
+
+        out = int16(qm * nb_re)
+        reps = 0
+        t = time.perf_counter()
+        while time.perf_counter() - t < 0.2:
+            qam_llr.llr(qm, rxF, chmag, out)
+            reps += 1
+        dt = (time.perf_counter() - t) / (reps * nb_re)
+        print("%3d-QAM: %8.1f MRE/s, plain Python %6.3f MRE/s (x%.0f)%s" % (
+            1 << qm, 1e-6 / dt, 1e-6 / dt_py, dt_py / dt, "" if ok else "  MISMATCH"))
+        s, e = (s + 1, e) if ok else (s, e + 1)
+
+    # wrong dtype, short output, too few chmag levels
+    bad_calls = [
+        lambda: qam_llr.llr(4, array.array("i", [0] * 8), chmag, int16(64)),
+        lambda: qam_llr.llr(4, rxF, chmag, int16(4 * nb_re - 1)),
+        lambda: qam_llr.llr(8, rxF, chmag[:2], int16(8 * nb_re)),
+        lambda: qam_llr.llr(5, rxF, chmag, int16(8 * nb_re)),
+        lambda: qam_llr.llr(4, rxF, chmag, bytes(8 * nb_re)),
+    ]
+    for call in bad_calls:
+        try:
+            call()
+            e += 1
+        except (TypeError, ValueError, BufferError):
+            s += 1
+
+    print("Python binding: Success = %d, Error = %d" % (s, e))
+    return e != 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
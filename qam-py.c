@@ -0,0 +1,227 @@
+/// @brief Python binding of the LLR kernels on buffer-protocol arrays, without copies
+///
+/// Build (NumPy is optional, any object exporting an int16 buffer works):
+///   gcc -O2 -march=native -shared -fPIC $(python3-config --includes) qam-py.c
+///       -o qam_llr$(python3-config --extension-suffix) -lpthread
+///
+/// qam_llr.llr(qm, rxF, chmag, out, threads=0) -> out
+///   qm       4, 6 or 8
+///   rxF      int16 buffer of 2 * nb_re interleaved I/Q samples, C-contiguous, any shape
+///   chmag    sequence of QAM_NB_CHMAG(qm) int16 buffers of 2 * nb_re samples each,
+///            e.g. a list of arrays or the rows of a (levels, 2 * nb_re) array
+///   out      writable int16 buffer of at least qm * nb_re LLRs
+///   threads  worker threads, 0 for one per online CPU
+/// qam_llr.llr_ref(qm, rxF, chmag, out) -> out
+///   the scalar reference, for bit-exactness checks
+///
+/// The kernels read the exported buffers in place and write the LLRs into out, so a batch of
+/// many codewords goes through as one contiguous array. The GIL is released while they run: the
+/// REs are split over the threads in multiples of 8, and other Python threads keep running.
+/// The exporters cannot resize the buffers until the call returns.
+///
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "qam-llr.h"
+
+#if defined(__AVX512BW__)
+#define QAM_PY_LLR qam_llr_avx512
+#define QAM_PY_ISA "avx512"
+#elif defined(__AVX2__)
+#define QAM_PY_LLR qam_llr_avx
+#define QAM_PY_ISA "avx2"
+#else
+#define QAM_PY_LLR qam_llr_sse
+#define QAM_PY_ISA "sse"
+#endif
+
+#define QAM_PY_MAX_THREADS 64
+#define QAM_PY_MIN_RE_THREAD 16384 // smaller parts cost more to start than they save
+
+typedef struct
+{
+  int qm;
+  const int16_t *rxF;
+  const int16_t *chmag[3];
+  uint32_t nb_re;
+  int16_t *llr;
+} qam_py_part_t;
+
+static void *qam_py_part(void *arg)
+{
+  qam_py_part_t *p = arg;
+  QAM_PY_LLR(p->qm, p->rxF, p->chmag, p->nb_re, p->llr);
+  return NULL;
+}
+
+/// @brief Demaps nb_re REs over up to nb_threads threads, the calling one included
+static void qam_py_run(int qm, const int16_t *rxF, const int16_t *const *chmag, size_t nb_re, int16_t *llr,
+                       int nb_threads)
+{
+  qam_py_part_t part[QAM_PY_MAX_THREADS];
+  pthread_t tid[QAM_PY_MAX_THREADS];
+  int started[QAM_PY_MAX_THREADS] = {0};
+  size_t per, re = 0;
+
+  if ((size_t)nb_threads * QAM_PY_MIN_RE_THREAD > nb_re)
+    nb_threads = (int)(nb_re / QAM_PY_MIN_RE_THREAD);
+  if (nb_threads < 1)
+    nb_threads = 1;
+  per = ((nb_re + nb_threads - 1) / nb_threads + 7) & ~(size_t)7;
+
+  for (int t = 0; t < nb_threads && re < nb_re; t++, re += per)
+  {
+    qam_py_part_t *p = &part[t];
+    p->qm = qm;
+    p->rxF = rxF + 2 * re;
+    for (int l = 0; l < QAM_NB_CHMAG(qm); l++)
+      p->chmag[l] = chmag[l] + 2 * re;
+    p->nb_re = (uint32_t)((nb_re - re < per) ? nb_re - re : per);
+    p->llr = llr + (size_t)qm * re;
+    // the last part runs on the calling thread, as does any part whose thread cannot start
+    if (t == nb_threads - 1 || re + per >= nb_re || pthread_create(&tid[t], NULL, qam_py_part, p))
+      qam_py_part(p);
+    else
+      started[t] = 1;
+  }
+  for (int t = 0; t < nb_threads; t++)
+    if (started[t])
+      pthread_join(tid[t], NULL);
+}
+
+/// @brief Exports o as a C-contiguous int16 buffer of at least min_items items
+static int qam_py_buffer(PyObject *o, Py_buffer *b, int writable, Py_ssize_t min_items, const char *name)
+{
+  if (PyObject_GetBuffer(o, b, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | (writable ? PyBUF_WRITABLE : 0)))
+    return -1;
+
+  // native or little-endian int16 only, the kernels do not swap bytes
+  const char *f = b->format ? b->format : "B";
+  if (*f == '@' || *f == '=' || *f == '<')
+    f++;
+  if (b->itemsize != 2 || strcmp(f, "h"))
+    PyErr_Format(PyExc_TypeError, "%s must be an int16 buffer, not format '%s'", name, b->format ? b->format : "B");
+  else if (b->len / 2 < min_items)
+    PyErr_Format(PyExc_ValueError, "%s holds %zd int16, %zd needed", name, b->len / 2, min_items);
+  else
+    return 0;
+  PyBuffer_Release(b);
+  return -1;
+}
+
+static PyObject *qam_py_call(PyObject *args, PyObject *kw, int ref)
+{
+  static char *kwlist[] = {"qm", "rxF", "chmag", "out", "threads", NULL};
+  static char *kwlist_ref[] = {"qm", "rxF", "chmag", "out", NULL};
+  PyObject *rxF_o, *chmag_o, *out_o, *seq = NULL, *ret = NULL;
+  Py_buffer rxF = {0}, chmag[3] = {{0}}, out = {0};
+  int qm, nb_threads = 0, nb_chmag = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kw, ref ? "iOOO" : "iOOO|i", ref ? kwlist_ref : kwlist, &qm, &rxF_o,
+                                   &chmag_o, &out_o, &nb_threads))
+    return NULL;
+  if (qm != 4 && qm != 6 && qm != 8)
+  {
+    PyErr_Format(PyExc_ValueError, "qm must be 4, 6 or 8, not %d", qm);
+    return NULL;
+  }
+  if (nb_threads < 0 || nb_threads > QAM_PY_MAX_THREADS)
+  {
+    PyErr_Format(PyExc_ValueError, "threads must be in [0, %d]", QAM_PY_MAX_THREADS);
+    return NULL;
+  }
+  if (!nb_threads)
+  {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    nb_threads = (n < 1) ? 1 : (n > QAM_PY_MAX_THREADS) ? QAM_PY_MAX_THREADS : (int)n;
+  }
+
+  if (qam_py_buffer(rxF_o, &rxF, 0, 0, "rxF"))
+    return NULL;
+  Py_ssize_t n = rxF.len / 2;
+  if (n & 1)
+  {
+    PyErr_SetString(PyExc_ValueError, "rxF must hold I/Q pairs");
+    goto out;
+  }
+  if (n / 2 > UINT32_MAX)
+  {
+    PyErr_SetString(PyExc_ValueError, "rxF is too large");
+    goto out;
+  }
+  if (!(seq = PySequence_Fast(chmag_o, "chmag must be a sequence of int16 buffers")))
+    goto out;
+  if (PySequence_Fast_GET_SIZE(seq) < QAM_NB_CHMAG(qm))
+  {
+    PyErr_Format(PyExc_ValueError, "chmag needs %d levels for qm = %d", QAM_NB_CHMAG(qm), qm);
+    goto out;
+  }
+  for (; nb_chmag < QAM_NB_CHMAG(qm); nb_chmag++)
+    if (qam_py_buffer(PySequence_Fast_GET_ITEM(seq, nb_chmag), &chmag[nb_chmag], 0, n, "chmag level"))
+      goto out;
+  if (qam_py_buffer(out_o, &out, 1, n / 2 * qm, "out"))
+    goto out;
+
+  const int16_t *c[3] = {chmag[0].buf, chmag[1].buf, chmag[2].buf};
+  Py_BEGIN_ALLOW_THREADS
+  if (ref)
+    qam_llr_ref(qm, rxF.buf, c, (uint32_t)(n / 2), out.buf);
+  else
+    qam_py_run(qm, rxF.buf, c, (size_t)n / 2, out.buf, nb_threads);
+  Py_END_ALLOW_THREADS
+
+  Py_INCREF(out_o);
+  ret = out_o;
+  PyBuffer_Release(&out);
+
+out:
+  for (int l = 0; l < nb_chmag; l++)
+    PyBuffer_Release(&chmag[l]);
+  PyBuffer_Release(&rxF);
+  Py_XDECREF(seq);
+  return ret;
+}
+
+static PyObject *qam_py_llr(PyObject *self, PyObject *args, PyObject *kw)
+{
+  (void)self;
+  return qam_py_call(args, kw, 0);
+}
+
+static PyObject *qam_py_llr_ref(PyObject *self, PyObject *args, PyObject *kw)
+{
+  (void)self;
+  return qam_py_call(args, kw, 1);
+}
+
+static PyMethodDef qam_py_methods[] = {
+    {"llr", (PyCFunction)(void (*)(void))qam_py_llr, METH_VARARGS | METH_KEYWORDS,
+     "llr(qm, rxF, chmag, out, threads=0) -> out\n\nMax-log LLRs of the int16 I/Q samples rxF into out, "
+     "with the SIMD kernel on several threads and the GIL released."},
+    {"llr_ref", (PyCFunction)(void (*)(void))qam_py_llr_ref, METH_VARARGS | METH_KEYWORDS,
+     "llr_ref(qm, rxF, chmag, out) -> out\n\nSame as llr() with the scalar reference."},
+    {NULL, NULL, 0, NULL},
+};
+
+static struct PyModuleDef qam_py_module = {
+    .m_base = PyModuleDef_HEAD_INIT,
+    .m_name = "qam_llr",
+    .m_doc = "Max-log QAM demapper kernels on int16 buffers",
+    .m_size = -1,
+    .m_methods = qam_py_methods,
+};
+
+PyMODINIT_FUNC PyInit_qam_llr(void)
+{
+  PyObject *m = PyModule_Create(&qam_py_module);
+
+  if (m && PyModule_AddStringConstant(m, "isa", QAM_PY_ISA))
+    Py_CLEAR(m);
+  return m;
+}
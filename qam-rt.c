@@ -0,0 +1,209 @@
+/// @brief Real-time mode demo: slot-paced per-symbol jobs on polling workers, with latency histograms
+///
+/// Usage: qam-rt [workers] [slots] [prio] [trace.json]      (default 1 2000 80, link with -lpthread)
+///   trace.json  Chrome trace of every job, one track per worker
+///
+/// Every 500 us slot submits the 12 data symbols of three allocations (100 PRBs of 256-QAM,
+/// 50 of 64-QAM, 25 of 16-QAM) as one job per symbol, waits for them and checks the LLRs.
+/// Workers go to the isolated CPUs if there are enough of them, else to the last CPUs of the
+/// affinity mask. The main thread keeps a CPU of its own; when none is left the workers run
+/// SCHED_OTHER, since a SCHED_FIFO poller would starve it. kill -USR1 prints the histograms
+/// while the demo runs.
+///
+
+#define _GNU_SOURCE
+#include <signal.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "qam-llr.h"
+#include "qam-rt.h"
+
+#define SLOT_NS 500000ULL
+#define NB_SYMB 12
+#define NB_ALLOC 3
+
+static const struct
+{
+  int qm;
+  uint32_t nb_re;
+} alloc[NB_ALLOC] = {{8, 100 * QAM_NB_RE_PRB}, {6, 50 * QAM_NB_RE_PRB}, {4, 25 * QAM_NB_RE_PRB}};
+
+static volatile sig_atomic_t dump;
+
+static void on_usr1(int sig)
+{
+  (void)sig;
+  dump = 1;
+}
+
+static uint64_t state = 0x6a09e667f3bcc909ULL;
+
+static uint32_t rand32(void)
+{
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  return (uint32_t)((state * 2685821657736338717ULL) >> 32);
+}
+
+static uint64_t now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+int main(int argc, char *argv[])
+{
+  int nb_workers = (argc > 1) ? atoi(argv[1]) : 1;
+  int nb_slots = (argc > 2) ? atoi(argv[2]) : 2000;
+  int prio = (argc > 3) ? atoi(argv[3]) : 80;
+  int cpus[QAM_RT_MAX_WORKERS], all[CPU_SETSIZE], nb_all = 0, nb_iso, s = 0, e = 0, ret;
+  cpu_set_t set;
+
+  if (nb_workers < 1 || nb_workers > QAM_RT_MAX_WORKERS || nb_slots < 1)
+  {
+    fprintf(stderr, "usage: %s [workers <= %d] [slots] [prio] [trace.json]\n", argv[0], QAM_RT_MAX_WORKERS);
+    return 1;
+  }
+
+  // Memory first, so that the buffers below are locked as they are allocated
+  if ((ret = qam_rt_lock_memory()))
+    printf("Memory: mlockall failed (%s), pages may still fault\n", strerror(-ret));
+  else
+    printf("Memory: locked\n");
+
+  // One grid per allocation, shared by the 12 symbols of a slot so that a slot needs no new input
+  size_t n = 2 * (size_t)alloc[0].nb_re * NB_SYMB;
+  int16_t *rxF = aligned_alloc(64, n * sizeof(int16_t)), *chmag[3], *llr[NB_ALLOC], *ref[NB_ALLOC];
+  for (size_t i = 0; i < n; i++)
+    rxF[i] = (int16_t)(rand32() % 2048) - 1024;
+  for (int l = 0; l < 3; l++)
+  {
+    chmag[l] = aligned_alloc(64, n * sizeof(int16_t));
+    for (size_t i = 0; i < n; i++)
+      chmag[l][i] = (int16_t)(512 >> l);
+  }
+  for (int a = 0; a < NB_ALLOC; a++)
+  {
+    size_t bytes = (size_t)alloc[a].qm * alloc[a].nb_re * NB_SYMB * sizeof(int16_t);
+    llr[a] = aligned_alloc(64, bytes);
+    ref[a] = malloc(bytes);
+    qam_llr_ref(alloc[a].qm, rxF, (const int16_t *const *)chmag, alloc[a].nb_re * NB_SYMB, ref[a]);
+    qam_rt_prefault(llr[a], bytes);
+  }
+  qam_rt_prefault(rxF, n * sizeof(int16_t));
+  for (int l = 0; l < 3; l++)
+    qam_rt_prefault(chmag[l], n * sizeof(int16_t));
+
+  // CPUs: isolated ones first, the main thread on one the workers do not use
+  sched_getaffinity(0, sizeof(set), &set);
+  for (int c = 0; c < CPU_SETSIZE; c++)
+    if (CPU_ISSET(c, &set))
+      all[nb_all++] = c;
+  nb_iso = qam_rt_isolated(cpus, nb_workers);
+  if (nb_iso < nb_workers)
+    for (int w = 0, first = (nb_all > nb_workers) ? nb_all - nb_workers : 0; w < nb_workers; w++)
+      cpus[w] = all[(first + w) % nb_all];
+  if (nb_iso < nb_workers && nb_all <= nb_workers)
+  {
+    printf("Workers: no CPU left for the main thread, polling workers run SCHED_OTHER\n");
+    prio = 0;
+  }
+  else
+  {
+    CPU_ZERO(&set);
+    CPU_SET(all[0], &set);
+    if (nb_iso < nb_workers)
+      sched_setaffinity(0, sizeof(set), &set);
+  }
+
+  static qam_rt_t rt;
+  if (qam_rt_init(&rt, nb_workers, cpus, prio))
+  {
+    fprintf(stderr, "cannot start the workers\n");
+    return 1;
+  }
+  for (int w = 0; w < nb_workers; w++)
+  {
+    printf("Worker %d: cpu %d%s, ", w, rt.worker[w].cpu, (nb_iso >= nb_workers) ? " (isolated)" : "");
+    if (rt.worker[w].fifo)
+      printf("SCHED_FIFO %d\n", prio);
+    else
+      printf("SCHED_OTHER%s\n", prio ? " (SCHED_FIFO not permitted)" : "");
+  }
+
+  struct sigaction sa = {.sa_handler = on_usr1, .sa_flags = SA_RESTART};
+  sigaction(SIGUSR1, &sa, NULL);
+
+  static qam_rt_job_t job[NB_ALLOC][NB_SYMB];
+  for (int a = 0; a < NB_ALLOC; a++)
+    for (int k = 0; k < NB_SYMB; k++)
+    {
+      qam_rt_job_t *j = &job[a][k];
+      size_t re0 = (size_t)alloc[a].nb_re * k;
+      j->qm = (uint8_t)alloc[a].qm;
+      j->nb_re = alloc[a].nb_re;
+      j->rxF = rxF + 2 * re0;
+      for (int l = 0; l < 3; l++)
+        j->chmag[l] = chmag[l] + 2 * re0;
+      j->llr = llr[a] + alloc[a].qm * re0;
+    }
+
+  uint64_t slot = now_ns() + SLOT_NS;
+  for (int t = 0; t < nb_slots; t++, slot += SLOT_NS)
+  {
+    struct timespec ts = {(time_t)(slot / 1000000000ULL), (long)(slot % 1000000000ULL)};
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+
+    // Symbol by symbol, all allocations of a symbol before the next one
+    for (int k = 0; k < NB_SYMB; k++)
+      for (int a = 0; a < NB_ALLOC; a++)
+        while (qam_rt_submit(&rt, &job[a][k]))
+          _mm_pause();
+    for (int k = 0; k < NB_SYMB; k++)
+      for (int a = 0; a < NB_ALLOC; a++)
+        qam_rt_wait(&job[a][k]);
+
+    int ok = 1;
+    for (int a = 0; a < NB_ALLOC; a++)
+    {
+      size_t bytes = (size_t)alloc[a].qm * alloc[a].nb_re * NB_SYMB * sizeof(int16_t);
+      ok &= !memcmp(llr[a], ref[a], bytes);
+      memset(llr[a], 0, bytes);
+    }
+    ok ? s++ : e++;
+
+    if (dump)
+    {
+      dump = 0;
+      qam_rt_report(&rt, stdout);
+      fflush(stdout);
+    }
+  }
+
+  qam_rt_stop(&rt);
+  qam_rt_report(&rt, stdout);
+  if (argc > 4)
+  {
+    long nb = qam_trace_export_chrome(argv[4]);
+    if (nb < 0)
+      printf("Error: cannot write %s\n", argv[4]);
+    else
+      printf("%ld trace events written to %s\n", nb, argv[4]);
+  }
+  printf("RT: Success = %d, Error = %d\n", s, e);
+
+  free(rxF);
+  for (int l = 0; l < 3; l++)
+    free(chmag[l]);
+  for (int a = 0; a < NB_ALLOC; a++)
+  {
+    free(llr[a]);
+    free(ref[a]);
+  }
+  return e != 0;
+}
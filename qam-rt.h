@@ -0,0 +1,367 @@
+/// @brief Real-time demapper engine: locked memory, SCHED_FIFO polling workers, latency histograms
+///
+/// The scheduler (qam-sched.h) sleeps in condition variables and takes a mutex per chunk, and
+/// either may end in a futex syscall and a wake-up delay. Here every worker owns a core and
+/// busy-polls its own single-producer ring, so once the engine runs the hot path is a ring
+/// load, the AVX2 kernel and two rdtsc, with no lock, no allocation and no syscall.
+///
+/// Before starting, qam_rt_lock_memory() keeps malloc from returning memory to the kernel,
+/// locks current and future pages with mlockall() and prefaults the caller's stack. Buffers
+/// allocated afterwards are prefaulted with qam_rt_prefault(). Workers prefault their own
+/// stacks before polling. Without the privileges for mlockall() or SCHED_FIFO the engine still
+/// runs, and qam_rt_init() reports what it could not get.
+///
+/// Each worker keeps one histogram per kernel (16/64/256-QAM) and one of the job latency from
+/// submission to completion. Buckets are log-linear in TSC cycles, 32 per octave (3 % wide),
+/// written by their worker only with plain stores. qam_rt_report() may run at any time from
+/// another thread and prints p50, p99, p99.99 and the maximum. The same two rdtsc also go to
+/// the worker's trace ring (qam-trace.h).
+///
+/// A polling worker never yields its core: give each one an isolated core (isolcpus=, see
+/// qam_rt_isolated()) that runs nothing else, the submitting thread included.
+///
+/// Needs _GNU_SOURCE defined before the first system include.
+///
+
+#ifndef QAM_RT_H
+#define QAM_RT_H
+
+#include <errno.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <x86intrin.h>
+
+#include "qam-llr.h"
+#include "qam-trace.h"
+
+#define QAM_RT_MAX_WORKERS 16
+#define QAM_RT_QUEUE 64 // jobs in flight per worker, power of 2
+#define QAM_RT_SUB_BITS 5 // 2^5 buckets per octave
+#define QAM_RT_MAX_BITS 40 // cycles beyond 2^40 land in the last bucket
+#define QAM_RT_NB_BUCKETS ((QAM_RT_MAX_BITS - QAM_RT_SUB_BITS + 1) << QAM_RT_SUB_BITS)
+#define QAM_RT_STACK_PREFAULT (256 * 1024)
+
+typedef enum
+{
+  QAM_RT_QAM16,
+  QAM_RT_QAM64,
+  QAM_RT_QAM256,
+  QAM_RT_JOB, // submission to completion
+  QAM_RT_NB_HIST,
+} qam_rt_hist_id_t;
+
+static const char *const qam_rt_hist_name[QAM_RT_NB_HIST] = {"16-QAM llr avx2", "64-QAM llr avx2", "256-QAM llr avx2",
+                                                             "job latency"};
+
+/// @brief Demapping job, owned by the caller until it completes
+typedef struct
+{
+  uint8_t qm;
+  const int16_t *rxF;
+  const int16_t *chmag[3];
+  uint32_t nb_re;
+  int16_t *llr;
+
+  // set by the engine
+  uint64_t submit_tsc;
+  uint64_t end_tsc;
+  _Atomic int complete;
+} qam_rt_job_t;
+
+/// @brief Latency histogram in TSC cycles, single writer
+typedef struct
+{
+  _Atomic uint64_t count[QAM_RT_NB_BUCKETS];
+  _Atomic uint64_t max;
+} qam_rt_hist_t;
+
+typedef struct
+{
+  alignas(64) _Atomic uint32_t head; // submitter
+  alignas(64) _Atomic uint32_t tail; // worker
+  qam_rt_job_t *job[QAM_RT_QUEUE];
+  qam_rt_hist_t hist[QAM_RT_NB_HIST];
+  pthread_t thread;
+  int cpu;
+  int fifo; // runs under SCHED_FIFO
+  _Atomic int *stop;
+} qam_rt_worker_t;
+
+typedef struct
+{
+  int nb_workers;
+  uint32_t next; // worker of the next job
+  double tsc_per_us;
+  _Atomic int stop;
+  qam_rt_worker_t worker[QAM_RT_MAX_WORKERS];
+} qam_rt_t;
+
+/// @brief Touches every page of [p, p + bytes) without changing its content
+static inline void qam_rt_prefault(void *p, size_t bytes)
+{
+  volatile uint8_t *b = p;
+  long page = sysconf(_SC_PAGESIZE);
+
+  for (size_t i = 0; i < bytes; i += (size_t)page)
+    b[i] = b[i];
+  if (bytes)
+    b[bytes - 1] = b[bytes - 1];
+}
+
+/// @brief Faults in QAM_RT_STACK_PREFAULT bytes of the calling thread's stack
+static inline void qam_rt_prefault_stack(void)
+{
+  volatile uint8_t stack[QAM_RT_STACK_PREFAULT];
+  long page = sysconf(_SC_PAGESIZE);
+
+  for (size_t i = 0; i < sizeof(stack); i += (size_t)page)
+    stack[i] = 0;
+}
+
+/// @brief Keeps the heap mapped, locks current and future pages and prefaults the stack
+/// @return 0 on success, -errno if mlockall() failed (the rest is done anyway)
+static inline int qam_rt_lock_memory(void)
+{
+  int ret = 0;
+
+  mallopt(M_TRIM_THRESHOLD, -1);
+  mallopt(M_MMAP_MAX, 0);
+  if (mlockall(MCL_CURRENT | MCL_FUTURE))
+    ret = -errno;
+  qam_rt_prefault_stack();
+  return ret;
+}
+
+/// @brief Reads the isolated CPUs (isolcpus= on the kernel command line)
+/// @return number of CPUs written to cpus, 0 if none are isolated
+static inline int qam_rt_isolated(int *cpus, int max)
+{
+  FILE *f = fopen("/sys/devices/system/cpu/isolated", "r");
+  int n = 0, a, b;
+  char sep;
+
+  if (!f)
+    return 0;
+  while (n < max && fscanf(f, "%d", &a) == 1)
+  {
+    b = a;
+    sep = 0;
+    if (fscanf(f, "%c", &sep) == 1 && sep == '-' && fscanf(f, "%d", &b) == 1)
+      fscanf(f, "%c", &sep);
+    for (int c = a; c <= b && n < max; c++)
+      cpus[n++] = c;
+    if (sep != ',')
+      break;
+  }
+  fclose(f);
+  return n;
+}
+
+static inline unsigned qam_rt_bucket(uint64_t v)
+{
+  if (v < (1u << QAM_RT_SUB_BITS))
+    return (unsigned)v;
+  unsigned msb = 63 - (unsigned)__builtin_clzll(v);
+  if (msb >= QAM_RT_MAX_BITS)
+    return QAM_RT_NB_BUCKETS - 1;
+  return ((msb - QAM_RT_SUB_BITS + 1) << QAM_RT_SUB_BITS) + (unsigned)(v >> (msb - QAM_RT_SUB_BITS)) -
+         (1u << QAM_RT_SUB_BITS);
+}
+
+/// @brief Largest value of bucket b
+static inline uint64_t qam_rt_bucket_max(unsigned b)
+{
+  unsigned oct = b >> QAM_RT_SUB_BITS, m = b & ((1u << QAM_RT_SUB_BITS) - 1);
+
+  if (!oct)
+    return b;
+  return (((uint64_t)m + (1u << QAM_RT_SUB_BITS) + 1) << (oct - 1)) - 1;
+}
+
+/// @brief Adds one sample; only the owner thread may call it
+static inline void qam_rt_hist_add(qam_rt_hist_t *h, uint64_t v)
+{
+  _Atomic uint64_t *c = &h->count[qam_rt_bucket(v)];
+
+  atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + 1, memory_order_relaxed);
+  if (v > atomic_load_explicit(&h->max, memory_order_relaxed))
+    atomic_store_explicit(&h->max, v, memory_order_relaxed);
+}
+
+/// @brief Value below which a fraction p of the samples fall, rounded up to the bucket edge
+static inline uint64_t qam_rt_percentile(const uint64_t *count, uint64_t nb, uint64_t max, double p)
+{
+  uint64_t rank = (uint64_t)(p * (double)nb), sum = 0;
+
+  if ((double)rank < p * (double)nb || !rank)
+    rank++;
+  for (unsigned b = 0; b < QAM_RT_NB_BUCKETS; b++)
+    if ((sum += count[b]) >= rank)
+    {
+      uint64_t v = qam_rt_bucket_max(b);
+      return (v < max) ? v : max;
+    }
+  return max;
+}
+
+static inline void *qam_rt_worker(void *arg)
+{
+  qam_rt_worker_t *w = arg;
+  uint32_t t = atomic_load_explicit(&w->tail, memory_order_relaxed);
+
+  qam_rt_prefault_stack();
+#ifndef QAM_TRACE_DISABLE
+  qam_trace_ring(); // allocated here, not on the first job
+#endif
+  while (!atomic_load_explicit(w->stop, memory_order_relaxed))
+  {
+    if (t == atomic_load_explicit(&w->head, memory_order_acquire))
+    {
+      _mm_pause();
+      continue;
+    }
+    qam_rt_job_t *job = w->job[t % QAM_RT_QUEUE];
+    uint64_t t0 = __rdtsc();
+    qam_llr_avx(job->qm, job->rxF, job->chmag, job->nb_re, job->llr);
+    uint64_t t1 = __rdtsc();
+
+    QAM_TRACE_EVENT(t0, t1, QAM_TRACE_LLR, QAM_TRACE_AVX2, job->qm, job->nb_re);
+    qam_rt_hist_add(&w->hist[(job->qm - 4) / 2], t1 - t0);
+    qam_rt_hist_add(&w->hist[QAM_RT_JOB], t1 - job->submit_tsc);
+    job->end_tsc = t1;
+    atomic_store_explicit(&job->complete, 1, memory_order_release);
+    atomic_store_explicit(&w->tail, ++t, memory_order_release);
+  }
+  return NULL;
+}
+
+/// @brief Creates the thread of w pinned to w->cpu, under SCHED_FIFO at prio if prio > 0
+static inline int qam_rt_spawn(qam_rt_worker_t *w, int prio)
+{
+  struct sched_param sp = {.sched_priority = prio};
+  pthread_attr_t attr;
+  cpu_set_t set;
+  int ret;
+
+  CPU_ZERO(&set);
+  CPU_SET(w->cpu, &set);
+  pthread_attr_init(&attr);
+  pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+  if (prio > 0)
+  {
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    pthread_attr_setschedparam(&attr, &sp);
+  }
+  ret = pthread_create(&w->thread, &attr, qam_rt_worker, w);
+  pthread_attr_destroy(&attr);
+  return ret;
+}
+
+/// @brief Stops and joins the workers; queued jobs may be left undone
+static inline void qam_rt_stop(qam_rt_t *rt)
+{
+  atomic_store(&rt->stop, 1);
+  for (int w = 0; w < rt->nb_workers; w++)
+    pthread_join(rt->worker[w].thread, NULL);
+}
+
+/// @brief Starts nb_workers polling workers pinned to cpus[i], under SCHED_FIFO at prio if prio > 0
+/// @return 0 on success, -1 on error after stopping the workers already started;
+///         worker[i].fifo tells whether SCHED_FIFO was granted
+static inline int qam_rt_init(qam_rt_t *rt, int nb_workers, const int *cpus, int prio)
+{
+  if (nb_workers < 1 || nb_workers > QAM_RT_MAX_WORKERS)
+    return -1;
+  memset(rt, 0, sizeof(*rt));
+  rt->tsc_per_us = qam_trace_calibrate();
+
+  for (; rt->nb_workers < nb_workers; rt->nb_workers++)
+  {
+    qam_rt_worker_t *w = &rt->worker[rt->nb_workers];
+    int ret;
+
+    w->cpu = cpus[rt->nb_workers];
+    w->stop = &rt->stop;
+    w->fifo = (prio > 0);
+    // Without CAP_SYS_NICE SCHED_FIFO fails with EPERM and the worker runs SCHED_OTHER
+    if ((ret = qam_rt_spawn(w, prio)) == EPERM && w->fifo)
+    {
+      w->fifo = 0;
+      ret = qam_rt_spawn(w, 0);
+    }
+    if (ret)
+    {
+      qam_rt_stop(rt);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/// @brief Hands job to the next worker; only one thread may submit
+/// @return 0 on success, -1 if the job is invalid or the worker's ring is full
+static inline int qam_rt_submit(qam_rt_t *rt, qam_rt_job_t *job)
+{
+  qam_rt_worker_t *w = &rt->worker[rt->next];
+  uint32_t h = atomic_load_explicit(&w->head, memory_order_relaxed);
+
+  if ((job->qm != 4 && job->qm != 6 && job->qm != 8) ||
+      h - atomic_load_explicit(&w->tail, memory_order_acquire) == QAM_RT_QUEUE)
+    return -1;
+  atomic_store_explicit(&job->complete, 0, memory_order_relaxed);
+  job->submit_tsc = __rdtsc();
+  w->job[h % QAM_RT_QUEUE] = job;
+  atomic_store_explicit(&w->head, h + 1, memory_order_release);
+  rt->next = (rt->next + 1 == (uint32_t)rt->nb_workers) ? 0 : rt->next + 1;
+  return 0;
+}
+
+/// @brief Spins until job has completed
+static inline void qam_rt_wait(const qam_rt_job_t *job)
+{
+  while (!atomic_load_explicit(&job->complete, memory_order_acquire))
+    _mm_pause();
+}
+
+/// @brief Prints p50, p99, p99.99 and max of every histogram with samples, merged over the workers
+static inline void qam_rt_report(const qam_rt_t *rt, FILE *f)
+{
+  uint64_t count[QAM_RT_NB_BUCKETS];
+
+  fprintf(f, "%-17s %10s %10s %10s %10s %10s\n", "", "samples", "p50 us", "p99 us", "p99.99 us", "max us");
+  for (int k = 0; k < QAM_RT_NB_HIST; k++)
+  {
+    uint64_t nb = 0, max = 0;
+
+    memset(count, 0, sizeof(count));
+    for (int i = 0; i < rt->nb_workers; i++)
+    {
+      const qam_rt_hist_t *h = &rt->worker[i].hist[k];
+      uint64_t m = atomic_load_explicit(&h->max, memory_order_relaxed);
+      for (unsigned b = 0; b < QAM_RT_NB_BUCKETS; b++)
+        count[b] += atomic_load_explicit(&h->count[b], memory_order_relaxed);
+      max = (m > max) ? m : max;
+    }
+    // the total of the copied buckets, so that the percentiles stay consistent while workers record
+    for (unsigned b = 0; b < QAM_RT_NB_BUCKETS; b++)
+      nb += count[b];
+    if (!nb)
+      continue;
+    fprintf(f, "%-17s %10llu %10.2f %10.2f %10.2f %10.2f\n", qam_rt_hist_name[k], (unsigned long long)nb,
+            qam_rt_percentile(count, nb, max, 0.5) / rt->tsc_per_us,
+            qam_rt_percentile(count, nb, max, 0.99) / rt->tsc_per_us,
+            qam_rt_percentile(count, nb, max, 0.9999) / rt->tsc_per_us, max / rt->tsc_per_us);
+  }
+}
+
+#endif
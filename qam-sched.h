@@ -0,0 +1,309 @@
+/// @brief Deadline-aware scheduler for demapping jobs of several cells across worker threads
+///
+/// Jobs carry a cell ID and an absolute CLOCK_MONOTONIC deadline. Workers take jobs earliest
+/// deadline first (or in submission order with QAM_SCHED_FIFO) and demap one chunk of REs at a
+/// time with the AVX2 kernel. After each chunk the job goes back to the queue, so a newly
+/// submitted urgent job preempts a large one at the next chunk boundary, and the chunks of one
+/// job spread over idle workers.
+///
+/// Completed jobs update the per-cell statistics: deadline misses and a slack histogram.
+/// Every chunk is recorded in the worker's trace ring (qam-trace.h).
+///
+/// Worker pinning needs _GNU_SOURCE defined before the first system include.
+///
+
+#ifndef QAM_SCHED_H
+#define QAM_SCHED_H
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "qam-llr.h"
+#include "qam-trace.h"
+
+#define QAM_SCHED_MAX_JOBS 1024
+#define QAM_SCHED_MAX_CELLS 32
+#define QAM_SCHED_MAX_WORKERS 64
+#define QAM_SCHED_NB_HIST 16 // bin 0: missed, bin 1: slack < 2 us, bin b: slack in [2^(b-1), 2^b) us
+#define QAM_SCHED_CHUNK_RE 1024
+
+typedef enum
+{
+  QAM_SCHED_EDF,  // earliest deadline first
+  QAM_SCHED_FIFO, // submission order
+} qam_sched_policy_t;
+
+/// @brief Demapping job, owned by the caller until it completes
+typedef struct qam_sched_job
+{
+  uint16_t cell_id;
+  uint8_t qm;
+  const int16_t *rxF;
+  const int16_t *chmag[3];
+  uint32_t nb_re;
+  int16_t *llr;
+  uint64_t deadline_ns; // absolute, qam_sched_now() time base
+
+  // set by the scheduler
+  uint64_t seq;
+  uint32_t next_re;         // first RE not handed out to a worker yet
+  uint32_t done_re;         // REs demapped so far
+  uint64_t finish_ns;
+  volatile int complete;
+} qam_sched_job_t;
+
+/// @brief Per-cell deadline statistics
+typedef struct
+{
+  uint64_t nb_jobs;
+  uint64_t nb_miss;
+  int64_t min_slack_ns;
+  uint64_t hist[QAM_SCHED_NB_HIST];
+} qam_sched_stats_t;
+
+typedef struct
+{
+  pthread_mutex_t lock;
+  pthread_cond_t ready; // queue not empty or stop
+  pthread_cond_t idle;  // no job pending
+  qam_sched_policy_t policy;
+  uint32_t chunk_re;
+  uint64_t seq;
+  qam_sched_job_t *heap[QAM_SCHED_MAX_JOBS];
+  int nb_heap;
+  int nb_idle; // workers waiting on ready
+  int nb_pending;
+  int stop;
+  int nb_workers;
+  pthread_t worker[QAM_SCHED_MAX_WORKERS];
+  qam_sched_stats_t cell[QAM_SCHED_MAX_CELLS];
+} qam_sched_t;
+
+static inline uint64_t qam_sched_now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/// @brief Ordering key of the queue: earlier first, submission order breaks ties
+static inline int qam_sched_before(const qam_sched_t *s, const qam_sched_job_t *a, const qam_sched_job_t *b)
+{
+  if (s->policy == QAM_SCHED_EDF && a->deadline_ns != b->deadline_ns)
+    return a->deadline_ns < b->deadline_ns;
+  return a->seq < b->seq;
+}
+
+static inline void qam_sched_push(qam_sched_t *s, qam_sched_job_t *job)
+{
+  int i = s->nb_heap++;
+
+  while (i > 0 && qam_sched_before(s, job, s->heap[(i - 1) / 2]))
+  {
+    s->heap[i] = s->heap[(i - 1) / 2];
+    i = (i - 1) / 2;
+  }
+  s->heap[i] = job;
+}
+
+static inline qam_sched_job_t *qam_sched_pop(qam_sched_t *s)
+{
+  qam_sched_job_t *top = s->heap[0], *last = s->heap[--s->nb_heap];
+  int i = 0;
+
+  for (;;)
+  {
+    int c = 2 * i + 1;
+    if (c >= s->nb_heap)
+      break;
+    if (c + 1 < s->nb_heap && qam_sched_before(s, s->heap[c + 1], s->heap[c]))
+      c++;
+    if (!qam_sched_before(s, s->heap[c], last))
+      break;
+    s->heap[i] = s->heap[c];
+    i = c;
+  }
+  s->heap[i] = last;
+  return top;
+}
+
+/// @brief Records the deadline outcome of a completed job, called with the lock held
+static inline void qam_sched_account(qam_sched_t *s, const qam_sched_job_t *job)
+{
+  qam_sched_stats_t *st = &s->cell[job->cell_id];
+  int64_t slack = (int64_t)(job->deadline_ns - job->finish_ns);
+  int b = 0;
+
+  if (slack < 0)
+    st->nb_miss++;
+  else
+  {
+    uint64_t us = (uint64_t)slack / 1000;
+    b = (us < 2) ? 1 : 64 - __builtin_clzll(us);
+    b = (b < QAM_SCHED_NB_HIST) ? b : QAM_SCHED_NB_HIST - 1;
+  }
+  if (!st->nb_jobs || slack < st->min_slack_ns)
+    st->min_slack_ns = slack;
+  st->nb_jobs++;
+  st->hist[b]++;
+}
+
+static inline void *qam_sched_worker(void *arg)
+{
+  qam_sched_t *s = arg;
+
+  pthread_mutex_lock(&s->lock);
+  for (;;)
+  {
+    while (!s->nb_heap && !s->stop)
+    {
+      s->nb_idle++;
+      pthread_cond_wait(&s->ready, &s->lock);
+      s->nb_idle--;
+    }
+    if (!s->nb_heap)
+      break;
+
+    // Claim one chunk; the rest of the job competes again with everything queued meanwhile
+    qam_sched_job_t *job = qam_sched_pop(s);
+    uint32_t re = job->next_re, n = job->nb_re - re;
+    if (s->chunk_re && n > s->chunk_re)
+      n = s->chunk_re;
+    job->next_re += n;
+    if (job->next_re < job->nb_re)
+    {
+      qam_sched_push(s, job);
+      if (s->nb_idle)
+        pthread_cond_signal(&s->ready);
+    }
+    pthread_mutex_unlock(&s->lock);
+
+    const int16_t *chmag[3];
+    for (int l = 0; l < QAM_NB_CHMAG(job->qm); l++)
+      chmag[l] = job->chmag[l] + 2 * re;
+    QAM_TRACE(QAM_TRACE_LLR, QAM_TRACE_AVX2, job->qm, n,
+              qam_llr_avx(job->qm, job->rxF + 2 * re, chmag, n, job->llr + (size_t)job->qm * re));
+
+    pthread_mutex_lock(&s->lock);
+    job->done_re += n;
+    if (job->done_re == job->nb_re)
+    {
+      job->finish_ns = qam_sched_now();
+      qam_sched_account(s, job);
+      job->complete = 1;
+      if (--s->nb_pending == 0)
+        pthread_cond_broadcast(&s->idle);
+    }
+  }
+  pthread_mutex_unlock(&s->lock);
+  return NULL;
+}
+
+/// @brief Drains the queue, joins the workers and releases the scheduler
+static inline void qam_sched_stop(qam_sched_t *s)
+{
+  pthread_mutex_lock(&s->lock);
+  s->stop = 1;
+  pthread_cond_broadcast(&s->ready);
+  pthread_mutex_unlock(&s->lock);
+  for (int w = 0; w < s->nb_workers; w++)
+    pthread_join(s->worker[w], NULL);
+  pthread_cond_destroy(&s->ready);
+  pthread_cond_destroy(&s->idle);
+  pthread_mutex_destroy(&s->lock);
+}
+
+/// @brief Starts nb_workers workers, pinned to cpus[i] when cpus is not NULL
+/// @param chunk_re preemption granularity in REs, rounded up to a multiple of 8; 0 runs jobs to completion
+/// @return 0 on success, -1 on error, after stopping the workers already started
+static inline int qam_sched_init(qam_sched_t *s, qam_sched_policy_t policy, uint32_t chunk_re, int nb_workers,
+                                 const int *cpus)
+{
+  if (nb_workers < 1 || nb_workers > QAM_SCHED_MAX_WORKERS)
+    return -1;
+  memset(s, 0, sizeof(*s));
+  pthread_mutex_init(&s->lock, NULL);
+  pthread_cond_init(&s->ready, NULL);
+  pthread_cond_init(&s->idle, NULL);
+  s->policy = policy;
+  s->chunk_re = (chunk_re + 7) & ~7u;
+
+  for (; s->nb_workers < nb_workers; s->nb_workers++)
+  {
+    if (pthread_create(&s->worker[s->nb_workers], NULL, qam_sched_worker, s))
+    {
+      qam_sched_stop(s);
+      return -1;
+    }
+    if (cpus)
+    {
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(cpus[s->nb_workers], &set);
+      pthread_setaffinity_np(s->worker[s->nb_workers], sizeof(set), &set);
+    }
+  }
+  return 0;
+}
+
+/// @brief Queues a job
+/// @return 0 on success, -1 if the job is invalid or the queue is full
+static inline int qam_sched_submit(qam_sched_t *s, qam_sched_job_t *job)
+{
+  if ((job->qm != 4 && job->qm != 6 && job->qm != 8) || !job->nb_re || job->cell_id >= QAM_SCHED_MAX_CELLS)
+    return -1;
+  job->next_re = 0;
+  job->done_re = 0;
+  job->complete = 0;
+
+  pthread_mutex_lock(&s->lock);
+  if (s->nb_heap == QAM_SCHED_MAX_JOBS)
+  {
+    pthread_mutex_unlock(&s->lock);
+    return -1;
+  }
+  job->seq = s->seq++;
+  s->nb_pending++;
+  qam_sched_push(s, job);
+  if (s->nb_idle)
+    pthread_cond_signal(&s->ready);
+  pthread_mutex_unlock(&s->lock);
+  return 0;
+}
+
+/// @brief Waits until every submitted job has completed
+static inline void qam_sched_wait(qam_sched_t *s)
+{
+  pthread_mutex_lock(&s->lock);
+  while (s->nb_pending)
+    pthread_cond_wait(&s->idle, &s->lock);
+  pthread_mutex_unlock(&s->lock);
+}
+
+/// @brief Prints misses, worst slack and the slack histogram of every cell that ran a job
+static inline void qam_sched_report(qam_sched_t *s, FILE *f)
+{
+  pthread_mutex_lock(&s->lock);
+  fprintf(f, "cell   jobs   miss  min slack us | missed <2");
+  for (int b = 2; b < QAM_SCHED_NB_HIST; b++)
+    fprintf(f, (b < QAM_SCHED_NB_HIST - 1) ? " <%d" : " >=%d", 1 << (b - (b == QAM_SCHED_NB_HIST - 1)));
+  fprintf(f, " us\n");
+  for (int c = 0; c < QAM_SCHED_MAX_CELLS; c++)
+  {
+    const qam_sched_stats_t *st = &s->cell[c];
+    if (!st->nb_jobs)
+      continue;
+    fprintf(f, "%4d %6llu %6llu %12.1f |", c, (unsigned long long)st->nb_jobs, (unsigned long long)st->nb_miss,
+            st->min_slack_ns / 1e3);
+    for (int b = 0; b < QAM_SCHED_NB_HIST; b++)
+      fprintf(f, " %llu", (unsigned long long)st->hist[b]);
+    fprintf(f, "\n");
+  }
+  pthread_mutex_unlock(&s->lock);
+}
+
+#endif
@@ -0,0 +1,250 @@
+/// @brief Multi-process test of the demapper daemon: one heavy and several light PHY processes share it
+///
+/// Usage: qam-svc-test [qam-svcd] [clients] [seconds] [workers]      (default ./qam-svcd 4 1 1)
+///
+/// Starts the daemon on a private socket, then forks the clients. Client 0 keeps full-band
+/// 256-QAM allocations queued; the others submit small 16/64-QAM allocations. Every client
+/// writes its samples into its own arena once, keeps a few requests in flight for the given
+/// time, and compares each completed request with qam_llr_ref(). The daemon serves the rings
+/// one chunk per client at a time, so the latency of the light clients stays close to the time
+/// of their own requests even with the heavy backlog. Client 1 also submits a request pointing
+/// out of its arena, which the daemon must reject. Before the clients start, a connection that
+/// never sends its handshake stays open for the whole run: the daemon must go on accepting.
+///
+
+#define _GNU_SOURCE
+#include <signal.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+
+#include "qam-llr.h"
+#include "qam-svc.h"
+
+#define DEPTH 4 // requests in flight per client
+#define NB_CFG 3
+#define MAX_LAT 65536
+
+typedef struct
+{
+  int qm;
+  uint32_t nb_re;
+  uint32_t re0; // first RE in the sample buffers
+} cfg_t;
+
+static const cfg_t heavy[NB_CFG] = {{8, 273 * QAM_NB_RE_PRB * 4, 0}, {8, 273 * QAM_NB_RE_PRB * 4, 9}, {8, 13100, 3}};
+static const cfg_t light[NB_CFG] = {{4, 4 * QAM_NB_RE_PRB, 0}, {6, 25 * QAM_NB_RE_PRB, 5}, {4, 101, 17}};
+
+static uint64_t state = 0x2545f4914f6cdd1dULL;
+
+static uint32_t rand32(void)
+{
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  return (uint32_t)((state * 2685821657736338717ULL) >> 32);
+}
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+/// @brief One PHY process; returns the number of errors
+static int client(const char *path, int k, double seconds)
+{
+  const cfg_t *cfg = k ? light : heavy;
+  uint32_t max_re = 0;
+  qam_svc_client_t c;
+  int err = 0;
+
+  for (int i = 0; i < NB_CFG; i++)
+    if (cfg[i].re0 + cfg[i].nb_re > max_re)
+      max_re = cfg[i].re0 + cfg[i].nb_re;
+  size_t n = 2 * (size_t)max_re;
+  if (qam_svc_connect(&c, path, (4 * n + 8 * max_re * DEPTH) * sizeof(int16_t) + 64 * (4 + DEPTH)))
+  {
+    printf("client %d: cannot connect: %s\n", k, strerror(errno));
+    return 1;
+  }
+
+  // Samples are produced straight into the arena: nothing is copied on the way to the daemon
+  int16_t *rxF = qam_svc_alloc(&c, n * sizeof(int16_t)), *chmag[3], *llr[DEPTH], *ref[NB_CFG];
+  for (int l = 0; l < 3; l++)
+    chmag[l] = qam_svc_alloc(&c, n * sizeof(int16_t));
+  for (int d = 0; d < DEPTH; d++)
+    llr[d] = qam_svc_alloc(&c, 8 * (size_t)max_re * sizeof(int16_t));
+  state += (uint64_t)k << 32;
+  for (size_t i = 0; i < n; i++)
+  {
+    rxF[i] = (int16_t)(rand32() % 8192) - 4096;
+    for (int l = 0; l < 3; l++)
+      chmag[l][i] = (int16_t)(rand32() % (4096 >> l));
+  }
+  for (int i = 0; i < NB_CFG; i++)
+  {
+    const int16_t *ch[3];
+    for (int l = 0; l < 3; l++)
+      ch[l] = chmag[l] + 2 * cfg[i].re0;
+    ref[i] = malloc((size_t)cfg[i].qm * cfg[i].nb_re * sizeof(int16_t));
+    qam_llr_ref(cfg[i].qm, rxF + 2 * cfg[i].re0, ch, cfg[i].nb_re, ref[i]);
+  }
+
+  static double lat[MAX_LAT];
+  double t_sub[DEPTH], t0 = now(), t_end = t0 + seconds;
+  int64_t id[DEPTH];
+  int which[DEPTH], nb_lat = 0;
+  long nb_req = 0, nb_re = 0;
+
+  // Keep DEPTH requests in flight and reap them in order
+  for (long r = 0;; r++)
+  {
+    int d = (int)(r % DEPTH);
+    if (r >= DEPTH)
+    {
+      const cfg_t *f = &cfg[which[d]];
+      int st = qam_svc_wait(&c, id[d]);
+      double t = now();
+      if (st != QAM_SVC_OK || memcmp(llr[d], ref[which[d]], (size_t)f->qm * f->nb_re * sizeof(int16_t)))
+        err++;
+      if (nb_lat < MAX_LAT)
+        lat[nb_lat++] = t - t_sub[d];
+      nb_req++;
+      nb_re += f->nb_re;
+      if (t > t_end)
+      {
+        // drain what is still in flight
+        for (long q = r + 1; q < r + DEPTH; q++)
+          if (qam_svc_wait(&c, id[q % DEPTH]) != QAM_SVC_OK)
+            err++;
+        break;
+      }
+    }
+    const cfg_t *f = &cfg[which[d] = (int)(r % NB_CFG)];
+    const int16_t *ch[3];
+    for (int l = 0; l < 3; l++)
+      ch[l] = chmag[l] + 2 * f->re0;
+    memset(llr[d], 0, (size_t)f->qm * f->nb_re * sizeof(int16_t));
+    t_sub[d] = now();
+    if ((id[d] = qam_svc_submit(&c, f->qm, rxF + 2 * f->re0, ch, f->nb_re, llr[d], (uint64_t)r)) < 0)
+    {
+      printf("client %d: ring full\n", k);
+      err++;
+      break;
+    }
+  }
+  double dt = now() - t0;
+
+  if (k == 1)
+  {
+    // llr past the end of the arena
+    uint64_t off[3] = {qam_svc_off(&c, chmag[0]), qam_svc_off(&c, chmag[1])};
+    int64_t bad = qam_svc_submit_off(&c, 4, 64, qam_svc_off(&c, rxF), off, c.size - 64, 0);
+    if (bad < 0 || qam_svc_wait(&c, bad) != QAM_SVC_EINVAL)
+      err++;
+  }
+
+  qsort(lat, (size_t)nb_lat, sizeof(double), cmp_double);
+  printf("client %d (%s): %5ld requests, %7.1f MRE/s, latency p50 %7.1f us, p99 %7.1f us, %d error(s)\n", k,
+         k ? "light" : "heavy", nb_req, nb_re / dt * 1e-6, nb_lat ? lat[nb_lat / 2] * 1e6 : 0.0,
+         nb_lat ? lat[nb_lat * 99 / 100] * 1e6 : 0.0, err);
+  for (int i = 0; i < NB_CFG; i++)
+    free(ref[i]);
+  qam_svc_close(&c);
+  return err;
+}
+
+int main(int argc, char *argv[])
+{
+  const char *daemon = (argc > 1) ? argv[1] : "./qam-svcd";
+  int nb_clients = (argc > 2) ? atoi(argv[2]) : 4;
+  double seconds = (argc > 3) ? atof(argv[3]) : 1.0;
+  const char *workers = (argc > 4) ? argv[4] : "1";
+  char path[108];
+  int s = 0, e = 0, status;
+
+  if (nb_clients < 2 || nb_clients > 32)
+  {
+    fprintf(stderr, "usage: %s [qam-svcd] [clients in [2, 32]] [seconds] [workers]\n", argv[0]);
+    return 1;
+  }
+  snprintf(path, sizeof(path), "/tmp/qam-svc-test.%d", (int)getpid());
+
+  fflush(stdout);
+  pid_t dpid = fork();
+  if (dpid == 0)
+  {
+    execl(daemon, daemon, path, workers, (char *)NULL);
+    perror(daemon);
+    _exit(127);
+  }
+
+  // The daemon may autotune before it listens
+  qam_svc_client_t probe;
+  double t0 = now();
+  while (qam_svc_connect(&probe, path, 4096))
+  {
+    if (waitpid(dpid, &status, WNOHANG) == dpid || now() - t0 > 30)
+    {
+      printf("Error: daemon not reachable on %s\n", path);
+      kill(dpid, SIGKILL);
+      return 1;
+    }
+    usleep(10000);
+  }
+
+  // Slots are handed out in order: the probe holds slot 0, the next connection gets slot 1
+  qam_svc_client_t second;
+  if (!qam_svc_connect(&second, path, 4096))
+  {
+    (probe.id == 0 && second.id == 1) ? s++ : e++;
+    qam_svc_close(&second);
+  }
+  else
+    e++;
+  qam_svc_close(&probe);
+
+  struct sockaddr_un addr = {.sun_family = AF_UNIX};
+  int silent = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+  snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+  if (silent < 0 || connect(silent, (struct sockaddr *)&addr, sizeof(addr)))
+    e++;
+
+  pid_t pid[32];
+  fflush(stdout);
+  for (int k = 0; k < nb_clients; k++)
+    if ((pid[k] = fork()) == 0)
+    {
+      int err = client(path, k, seconds);
+      fflush(stdout);
+      _exit(err > 255 ? 255 : err);
+    }
+  for (int k = 0; k < nb_clients; k++)
+  {
+    if (pid[k] > 0 && waitpid(pid[k], &status, 0) == pid[k] && WIFEXITED(status) && !WEXITSTATUS(status))
+      s++;
+    else
+      e++;
+  }
+
+  if (silent >= 0)
+    close(silent);
+  kill(dpid, SIGTERM);
+  if (waitpid(dpid, &status, 0) == dpid && WIFEXITED(status) && !WEXITSTATUS(status))
+    s++;
+  else
+    e++;
+
+  printf("Demapper service: Success = %d, Error = %d\n", s, e);
+  return e != 0;
+}
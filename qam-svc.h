@@ -0,0 +1,324 @@
+/// @brief Shared-memory demapper service: request rings, doorbell and the client side
+///
+/// One daemon (qam-svcd.c) serves the LLR kernels to every PHY process of the host with a single
+/// pinned worker pool. A client puts a request ring and a data arena in one sealed memfd and
+/// passes it over a Unix socket (SCM_RIGHTS). The daemon maps the memfd, and its workers read
+/// rxF/chmag from the arena and write the LLRs back into it, so sample and LLR data are never
+/// copied. The socket carries only the connection handshake. The daemon answers with the fd of its
+/// doorbell page, which clients bump after publishing requests.
+///
+/// Requests are claimed by the workers one chunk of REs at a time, one client after the other,
+/// so a backlogged client gets the same share of chunks as any other and a large request cannot
+/// hold the pool. Ring indices and offsets written by the client are untrusted: the workers copy
+/// a request before checking it against the mapping, and reject it with QAM_SVC_EINVAL. The
+/// claim cursor the workers share stays in the daemon, out of reach of the client.
+///
+/// Idle workers sleep on the doorbell futex and a waiting client on its completion counter;
+/// both sides only make the wake-up syscall when the other one announced it is sleeping.
+///
+/// memfd_create() needs _GNU_SOURCE defined before the first system include.
+///
+
+#ifndef QAM_SVC_H
+#define QAM_SVC_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "qam-llr.h"
+
+#define QAM_SVC_MAGIC 0x43565351 // "QSVC"
+#define QAM_SVC_VERSION 2
+#define QAM_SVC_RING 256 // requests in flight per client, power of 2
+#define QAM_SVC_SPIN_NS 20000 // time a waiting client spins before sleeping
+
+typedef enum
+{
+  QAM_SVC_PENDING = 0,
+  QAM_SVC_OK = 1,
+  QAM_SVC_EINVAL = -1, // out-of-range offsets or unsupported qm
+} qam_svc_status_t;
+
+/// @brief One request: demap nb_re REs of modulation order qm; offsets are bytes into the memfd
+typedef struct
+{
+  alignas(64) uint32_t qm;
+  uint32_t nb_re;
+  uint64_t rxF;
+  uint64_t chmag[3];
+  uint64_t llr;
+  uint64_t tag;              // free for the client
+  _Atomic uint32_t re_done;  // daemon: REs demapped so far
+  _Atomic int32_t status;    // qam_svc_status_t, set by the daemon once all REs are done
+} qam_svc_req_t;
+
+/// @brief Head of a client memfd, followed by the data arena
+typedef struct
+{
+  uint32_t magic;
+  uint32_t version;
+  uint64_t data; // offset of the arena
+  alignas(64) _Atomic uint32_t head;     // client: requests published
+  alignas(64) _Atomic uint32_t tail;     // client: requests reaped, their slots may be reused
+  alignas(64) _Atomic uint32_t done_seq; // daemon: completed requests, futex word of the client
+  _Atomic uint32_t waiting;              // client sleeps on done_seq
+  qam_svc_req_t req[QAM_SVC_RING];
+} qam_svc_ring_t;
+
+/// @brief Daemon doorbell page shared with every client
+typedef struct
+{
+  alignas(64) _Atomic uint32_t seq; // bumped by clients after publishing, futex word of idle workers
+  _Atomic uint32_t sleepers;        // idle workers
+} qam_svc_bell_t;
+
+/// @brief Handshake message of both directions, the fd travels as SCM_RIGHTS
+typedef struct
+{
+  uint32_t magic;
+  uint32_t version;
+  int32_t status; // reply: 0 or -errno
+  uint32_t id;    // reply: client slot in the daemon
+} qam_svc_hello_t;
+
+static inline long qam_svc_futex(_Atomic uint32_t *addr, int op, uint32_t val)
+{
+  return syscall(SYS_futex, (uint32_t *)addr, op, val, NULL, NULL, 0);
+}
+
+/// @brief Sends msg with an optional fd
+static inline int qam_svc_send(int sock, const qam_svc_hello_t *msg, int fd)
+{
+  char ctl[CMSG_SPACE(sizeof(int))];
+  struct iovec iov = {(void *)msg, sizeof(*msg)};
+  struct msghdr mh = {.msg_iov = &iov, .msg_iovlen = 1};
+
+  memset(ctl, 0, sizeof(ctl));
+  if (fd >= 0)
+  {
+    mh.msg_control = ctl;
+    mh.msg_controllen = sizeof(ctl);
+    struct cmsghdr *c = CMSG_FIRSTHDR(&mh);
+    c->cmsg_level = SOL_SOCKET;
+    c->cmsg_type = SCM_RIGHTS;
+    c->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(c), &fd, sizeof(int));
+  }
+  return (sendmsg(sock, &mh, MSG_NOSIGNAL) == (ssize_t)sizeof(*msg)) ? 0 : -1;
+}
+
+/// @brief Receives msg and the fd that came with it (-1 if none)
+static inline int qam_svc_recv(int sock, qam_svc_hello_t *msg, int *fd)
+{
+  char ctl[CMSG_SPACE(sizeof(int))];
+  struct iovec iov = {msg, sizeof(*msg)};
+  struct msghdr mh = {.msg_iov = &iov, .msg_iovlen = 1, .msg_control = ctl, .msg_controllen = sizeof(ctl)};
+
+  *fd = -1;
+  if (recvmsg(sock, &mh, MSG_CMSG_CLOEXEC) != (ssize_t)sizeof(*msg))
+    return -1;
+  for (struct cmsghdr *c = CMSG_FIRSTHDR(&mh); c; c = CMSG_NXTHDR(&mh, c))
+    if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_RIGHTS)
+      memcpy(fd, CMSG_DATA(c), sizeof(int));
+  return 0;
+}
+
+/// ------------------------------------ Client ------------------------------------
+
+typedef struct
+{
+  int sock;
+  int memfd;
+  size_t size;           // bytes of the mapping
+  qam_svc_ring_t *ring;  // start of the mapping
+  qam_svc_bell_t *bell;
+  uint8_t *arena;
+  size_t arena_size;
+  size_t arena_used;
+  uint32_t id;
+} qam_svc_client_t;
+
+/// @brief Creates the memfd with arena_size bytes of data, seals its size and registers it
+/// @return 0 on success, -1 with errno set on error
+static inline int qam_svc_connect(qam_svc_client_t *c, const char *path, size_t arena_size)
+{
+  struct sockaddr_un addr = {.sun_family = AF_UNIX};
+  size_t head = (sizeof(qam_svc_ring_t) + 4095) & ~(size_t)4095;
+  qam_svc_hello_t hello = {QAM_SVC_MAGIC, QAM_SVC_VERSION, 0, 0}, reply;
+  int bell_fd = -1;
+
+  memset(c, 0, sizeof(*c));
+  c->sock = c->memfd = -1;
+  c->size = head + ((arena_size + 4095) & ~(size_t)4095);
+  strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+  if ((c->memfd = memfd_create("qam-svc", MFD_CLOEXEC | MFD_ALLOW_SEALING)) < 0 ||
+      ftruncate(c->memfd, (off_t)c->size) ||
+      fcntl(c->memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) ||
+      (c->ring = mmap(NULL, c->size, PROT_READ | PROT_WRITE, MAP_SHARED, c->memfd, 0)) == MAP_FAILED)
+    goto fail;
+  c->ring->magic = QAM_SVC_MAGIC;
+  c->ring->version = QAM_SVC_VERSION;
+  c->ring->data = head;
+  c->arena = (uint8_t *)c->ring + head;
+  c->arena_size = c->size - head;
+
+  if ((c->sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0)) < 0 ||
+      connect(c->sock, (struct sockaddr *)&addr, sizeof(addr)) || qam_svc_send(c->sock, &hello, c->memfd) ||
+      qam_svc_recv(c->sock, &reply, &bell_fd))
+    goto fail;
+  if (reply.status || bell_fd < 0)
+  {
+    errno = reply.status ? -reply.status : EPROTO;
+    goto fail;
+  }
+  c->bell = mmap(NULL, sizeof(qam_svc_bell_t), PROT_READ | PROT_WRITE, MAP_SHARED, bell_fd, 0);
+  close(bell_fd);
+  if (c->bell == MAP_FAILED)
+    goto fail;
+  c->id = reply.id;
+  return 0;
+
+fail:
+  if (bell_fd >= 0)
+    close(bell_fd);
+  if (c->ring && c->ring != MAP_FAILED)
+    munmap(c->ring, c->size);
+  if (c->memfd >= 0)
+    close(c->memfd);
+  if (c->sock >= 0)
+    close(c->sock);
+  c->ring = NULL;
+  c->bell = NULL;
+  return -1;
+}
+
+/// @brief Disconnects; the daemon unmaps the memfd once its workers are done with it
+static inline void qam_svc_close(qam_svc_client_t *c)
+{
+  if (c->bell)
+    munmap(c->bell, sizeof(qam_svc_bell_t));
+  if (c->ring)
+    munmap(c->ring, c->size);
+  close(c->memfd);
+  close(c->sock);
+  c->ring = NULL;
+  c->bell = NULL;
+}
+
+/// @brief Bump allocation of 64-byte aligned arena memory, NULL when the arena is full
+static inline void *qam_svc_alloc(qam_svc_client_t *c, size_t bytes)
+{
+  size_t off = (c->arena_used + 63) & ~(size_t)63;
+
+  if (off > c->arena_size || bytes > c->arena_size - off)
+    return NULL;
+  c->arena_used = off + bytes;
+  return c->arena + off;
+}
+
+/// @brief Byte offset of an arena pointer in the memfd
+static inline uint64_t qam_svc_off(const qam_svc_client_t *c, const void *p)
+{
+  return (uint64_t)((const uint8_t *)p - (const uint8_t *)c->ring);
+}
+
+/// @brief Frees the slots of the completed requests at the tail of the ring
+static inline void qam_svc_reap(qam_svc_client_t *c)
+{
+  qam_svc_ring_t *r = c->ring;
+  uint32_t t = atomic_load_explicit(&r->tail, memory_order_relaxed);
+  uint32_t h = atomic_load_explicit(&r->head, memory_order_relaxed);
+
+  while (t != h && atomic_load_explicit(&r->req[t % QAM_SVC_RING].status, memory_order_acquire) != QAM_SVC_PENDING)
+    t++;
+  atomic_store_explicit(&r->tail, t, memory_order_release);
+}
+
+/// @brief Publishes a request given by memfd offsets
+/// @return request number to wait on, -1 if the ring is full
+static inline int64_t qam_svc_submit_off(qam_svc_client_t *c, int qm, uint32_t nb_re, uint64_t rxF,
+                                         const uint64_t *chmag, uint64_t llr, uint64_t tag)
+{
+  qam_svc_ring_t *r = c->ring;
+  uint32_t h = atomic_load_explicit(&r->head, memory_order_relaxed);
+
+  if (h - atomic_load_explicit(&r->tail, memory_order_relaxed) == QAM_SVC_RING)
+  {
+    qam_svc_reap(c);
+    if (h - atomic_load_explicit(&r->tail, memory_order_relaxed) == QAM_SVC_RING)
+      return -1;
+  }
+  qam_svc_req_t *q = &r->req[h % QAM_SVC_RING];
+  q->qm = (uint32_t)qm;
+  q->nb_re = nb_re;
+  q->rxF = rxF;
+  for (int l = 0; l < 3; l++)
+    q->chmag[l] = (l < QAM_NB_CHMAG(qm)) ? chmag[l] : 0;
+  q->llr = llr;
+  q->tag = tag;
+  atomic_store_explicit(&q->re_done, 0, memory_order_relaxed);
+  atomic_store_explicit(&q->status, QAM_SVC_PENDING, memory_order_relaxed);
+  atomic_store_explicit(&r->head, h + 1, memory_order_release);
+
+  // ring the doorbell; the syscall only when a worker sleeps
+  atomic_fetch_add(&c->bell->seq, 1);
+  if (atomic_load(&c->bell->sleepers))
+    qam_svc_futex(&c->bell->seq, FUTEX_WAKE, 1);
+  return h;
+}
+
+/// @brief Publishes a request whose buffers lie in the arena, see qam_svc_submit_off()
+static inline int64_t qam_svc_submit(qam_svc_client_t *c, int qm, const int16_t *rxF, const int16_t *const *chmag,
+                                     uint32_t nb_re, int16_t *llr, uint64_t tag)
+{
+  uint64_t off[3] = {0};
+
+  for (int l = 0; l < QAM_NB_CHMAG(qm); l++)
+    off[l] = qam_svc_off(c, chmag[l]);
+  return qam_svc_submit_off(c, qm, nb_re, qam_svc_off(c, rxF), off, qam_svc_off(c, llr), tag);
+}
+
+/// @brief Status of request id without waiting
+static inline int qam_svc_status(const qam_svc_client_t *c, int64_t id)
+{
+  return atomic_load_explicit(&c->ring->req[(uint32_t)id % QAM_SVC_RING].status, memory_order_acquire);
+}
+
+/// @brief Waits for request id: spins for QAM_SVC_SPIN_NS, then sleeps on the completion counter
+/// @return QAM_SVC_OK or QAM_SVC_EINVAL
+static inline int qam_svc_wait(qam_svc_client_t *c, int64_t id)
+{
+  qam_svc_ring_t *r = c->ring;
+  struct timespec t0, t;
+  int st;
+
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  while ((st = qam_svc_status(c, id)) == QAM_SVC_PENDING)
+  {
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    if ((t.tv_sec - t0.tv_sec) * 1000000000LL + (t.tv_nsec - t0.tv_nsec) < QAM_SVC_SPIN_NS)
+      continue;
+    uint32_t seq = atomic_load(&r->done_seq);
+    atomic_store(&r->waiting, 1);
+    if ((st = atomic_load(&r->req[(uint32_t)id % QAM_SVC_RING].status)) != QAM_SVC_PENDING)
+      break;
+    qam_svc_futex(&r->done_seq, FUTEX_WAIT, seq);
+  }
+  atomic_store(&r->waiting, 0);
+  qam_svc_reap(c);
+  return st;
+}
+
+#endif
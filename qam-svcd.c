@@ -0,0 +1,413 @@
+/// @brief Demapper daemon: serves the LLR kernels to the PHY processes of the host, see qam-svc.h
+///
+/// Usage: qam-svcd <socket> [workers] [cpus] [chunk_re]      (link with -lpthread)
+///   workers   worker threads, default 1
+///   cpus      comma-separated CPUs to pin the workers to, default the first CPUs of the affinity mask
+///   chunk_re  REs claimed at a time, the fairness quantum between clients; default the chunk size
+///             autotuned for each qm, or 1024 where the tuner picked whole buffers
+///
+/// The kernel of each qm is picked by the autotuner (qam-tune.h) at startup. SIGINT or SIGTERM
+/// stops the daemon, which then prints what it served to every client, and writes the Chrome
+/// trace of every chunk (qam-trace.h) to $QAM_TRACE_FILE if it is set.
+///
+
+#define _GNU_SOURCE
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "qam-llr.h"
+#include "qam-svc.h"
+#include "qam-trace.h"
+#include "qam-tune.h"
+
+#define SVC_MAX_CLIENTS 64
+#define SVC_MAX_WORKERS 64
+#define SVC_CHUNK_RE 1024
+#define SVC_HELLO_MS 200 // a client that has not sent its hello by then is dropped
+
+typedef struct
+{
+  _Atomic int active;    // workers may serve the client
+  _Atomic uint32_t busy; // workers inside the mapping
+  _Atomic uint64_t claim; // request index << 32 | first RE not yet claimed
+  int sock;
+  int memfd;
+  pid_t pid;
+  qam_svc_ring_t *ring;
+  uint64_t size; // bytes of the mapping, from fstat
+  uint64_t data; // lowest offset a request may use
+  _Atomic uint64_t nb_req, nb_re, nb_chunk, nb_rejected;
+} svc_client_t;
+
+typedef struct
+{
+  qam_tune_t tune;
+  uint32_t chunk_re[3]; // per qm = 4, 6, 8
+  int nb_workers;
+  pthread_t worker[SVC_MAX_WORKERS];
+  qam_svc_bell_t *bell;
+  int bell_fd;
+  _Atomic int stop;
+  _Atomic uint32_t rr;      // next client to look at
+  _Atomic uint32_t nb_slots; // high-water mark of the client table
+  svc_client_t client[SVC_MAX_CLIENTS];
+} svc_t;
+
+static volatile sig_atomic_t quit;
+
+static void on_signal(int sig)
+{
+  (void)sig;
+  quit = 1;
+}
+
+/// @brief Whether [off, off + bytes) lies in the arena and is int16-aligned
+static int svc_in_range(const svc_client_t *c, uint64_t off, uint64_t bytes)
+{
+  return !(off & 1) && off >= c->data && off <= c->size && bytes <= c->size - off;
+}
+
+static void svc_complete(qam_svc_ring_t *r, qam_svc_req_t *q, int status)
+{
+  atomic_store(&q->status, status);
+  atomic_fetch_add(&r->done_seq, 1);
+  if (atomic_load(&r->waiting))
+    qam_svc_futex(&r->done_seq, FUTEX_WAKE, INT_MAX);
+}
+
+/// @brief Claims and demaps one chunk of the oldest unclaimed request of client c
+/// @return 1 if a chunk was served, 0 if the ring is empty
+static int svc_serve(svc_t *d, svc_client_t *c)
+{
+  qam_svc_ring_t *r = c->ring;
+  uint64_t cl = atomic_load(&c->claim), next, rxF, chmag[3], llr;
+  uint32_t idx, re, n, nb_re;
+  qam_svc_req_t *q;
+  int qm, ok;
+
+  // Everything in the ring is written by the client: copy the request, then check the copy
+  do
+  {
+    idx = (uint32_t)(cl >> 32);
+    re = (uint32_t)cl;
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    if (head == idx || head - idx > QAM_SVC_RING)
+      return 0;
+    q = &r->req[idx % QAM_SVC_RING];
+    qm = (int)q->qm;
+    nb_re = q->nb_re;
+    rxF = q->rxF;
+    llr = q->llr;
+    ok = (qm == 4 || qm == 6 || qm == 8) && svc_in_range(c, rxF, 4 * (uint64_t)nb_re) &&
+         svc_in_range(c, llr, 2 * (uint64_t)qm * nb_re);
+    for (int l = 0; ok && l < QAM_NB_CHMAG(qm); l++)
+      ok = svc_in_range(c, chmag[l] = q->chmag[l], 4 * (uint64_t)nb_re);
+    n = (ok && re < nb_re) ? nb_re - re : 0;
+    if (ok && n > d->chunk_re[(qm - 4) / 2])
+      n = d->chunk_re[(qm - 4) / 2];
+    next = (re + n < nb_re && ok) ? cl + n : (uint64_t)(idx + 1) << 32;
+  } while (!atomic_compare_exchange_weak(&c->claim, &cl, next));
+
+  if (!ok)
+  {
+    atomic_fetch_add_explicit(&c->nb_rejected, 1, memory_order_relaxed);
+    svc_complete(r, q, QAM_SVC_EINVAL);
+    return 1;
+  }
+
+  const uint8_t *base = (const uint8_t *)r;
+  const int16_t *ch[3];
+  for (int l = 0; l < QAM_NB_CHMAG(qm); l++)
+    ch[l] = (const int16_t *)(base + chmag[l]) + 2 * (size_t)re;
+  QAM_TRACE(QAM_TRACE_LLR, (qam_trace_isa_t)(QAM_TRACE_SSE + qam_tune_cfg(&d->tune, qm)->isa), qm, n,
+            qam_tune_llr(&d->tune, qm, (const int16_t *)(base + rxF) + 2 * (size_t)re, ch, n,
+                         (int16_t *)(base + llr) + (size_t)qm * re));
+
+  atomic_fetch_add_explicit(&c->nb_chunk, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&c->nb_re, n, memory_order_relaxed);
+  if (atomic_fetch_add(&q->re_done, n) + n == nb_re)
+  {
+    atomic_fetch_add_explicit(&c->nb_req, 1, memory_order_relaxed);
+    svc_complete(r, q, QAM_SVC_OK);
+  }
+  return 1;
+}
+
+/// @brief Serves one chunk of the first client with work, starting after the last one served
+/// @return 1 if a chunk was served
+static int svc_scan(svc_t *d)
+{
+  uint32_t nb = atomic_load(&d->nb_slots), start = atomic_load_explicit(&d->rr, memory_order_relaxed);
+
+  for (uint32_t k = 0; k < nb; k++)
+  {
+    uint32_t i = (start + k) % nb;
+    svc_client_t *c = &d->client[i];
+    int served = 0;
+
+    if (!atomic_load_explicit(&c->active, memory_order_relaxed))
+      continue;
+    atomic_fetch_add(&c->busy, 1);
+    if (atomic_load(&c->active))
+      served = svc_serve(d, c);
+    atomic_fetch_sub(&c->busy, 1);
+    if (served)
+    {
+      atomic_store_explicit(&d->rr, i + 1, memory_order_relaxed);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static void *svc_worker(void *arg)
+{
+  svc_t *d = arg;
+
+  while (!atomic_load_explicit(&d->stop, memory_order_relaxed))
+  {
+    if (svc_scan(d))
+      continue;
+    // Nothing queued: the sequence is read before the last scan, so a request published after it
+    // makes the futex return at once
+    uint32_t seq = atomic_load(&d->bell->seq);
+    atomic_fetch_add(&d->bell->sleepers, 1);
+    if (!svc_scan(d) && !atomic_load(&d->stop))
+      qam_svc_futex(&d->bell->seq, FUTEX_WAIT, seq);
+    atomic_fetch_sub(&d->bell->sleepers, 1);
+  }
+  return NULL;
+}
+
+/// @brief Maps the memfd of a new connection and answers with the doorbell
+static void svc_accept(svc_t *d, int sock)
+{
+  qam_svc_hello_t hello, reply = {QAM_SVC_MAGIC, QAM_SVC_VERSION, 0, 0};
+  struct timeval tv = {0, SVC_HELLO_MS * 1000};
+  struct ucred cred = {0};
+  socklen_t len = sizeof(cred);
+  struct stat st;
+  svc_client_t *c = NULL;
+  int fd = -1, seals;
+
+  // The handshake runs on the main loop: a client that connects and stays silent must not hold it
+  setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  getsockopt(sock, SOL_SOCKET, SO_PEERCRED, &cred, &len);
+  for (int i = 0; i < SVC_MAX_CLIENTS && !c; i++)
+    if (d->client[i].sock < 0)
+      c = &d->client[i];
+  if (c)
+    reply.id = (uint32_t)(c - d->client);
+
+  // The size must be sealed: a client shrinking its memfd would fault the workers
+  if (qam_svc_recv(sock, &hello, &fd) || hello.magic != QAM_SVC_MAGIC || hello.version != QAM_SVC_VERSION || fd < 0)
+    reply.status = -EPROTO;
+  else if (!c)
+    reply.status = -EUSERS;
+  else if (fstat(fd, &st) || (seals = fcntl(fd, F_GET_SEALS)) < 0 || !(seals & F_SEAL_SHRINK) ||
+           (uint64_t)st.st_size < sizeof(qam_svc_ring_t))
+    reply.status = -EINVAL;
+  else if ((c->ring = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED)
+    reply.status = -errno;
+  else if (c->ring->magic != QAM_SVC_MAGIC || c->ring->data < sizeof(qam_svc_ring_t) ||
+           c->ring->data > (uint64_t)st.st_size)
+  {
+    munmap(c->ring, (size_t)st.st_size);
+    reply.status = -EINVAL;
+  }
+
+  if (reply.status || qam_svc_send(sock, &reply, d->bell_fd))
+  {
+    fprintf(stderr, "qam-svcd: client pid %d refused: %s\n", (int)cred.pid,
+            reply.status ? strerror(-reply.status) : "cannot reply");
+    if (!reply.status)
+      munmap(c->ring, (size_t)st.st_size);
+    if (fd >= 0)
+      close(fd);
+    close(sock);
+    return;
+  }
+  c->sock = sock;
+  c->memfd = fd;
+  c->pid = cred.pid;
+  c->size = (uint64_t)st.st_size;
+  c->data = c->ring->data;
+  atomic_store(&c->nb_req, 0);
+  atomic_store(&c->nb_re, 0);
+  atomic_store(&c->nb_chunk, 0);
+  atomic_store(&c->nb_rejected, 0);
+  atomic_store(&c->claim, 0);
+  if (reply.id >= atomic_load(&d->nb_slots))
+    atomic_store(&d->nb_slots, reply.id + 1);
+  atomic_store(&c->active, 1);
+}
+
+static void svc_report(const svc_client_t *c, uint32_t id)
+{
+  printf("qam-svcd: client %u (pid %d): %lu requests, %lu REs in %lu chunks, %lu rejected\n", id, (int)c->pid,
+         (unsigned long)atomic_load(&c->nb_req), (unsigned long)atomic_load(&c->nb_re),
+         (unsigned long)atomic_load(&c->nb_chunk), (unsigned long)atomic_load(&c->nb_rejected));
+}
+
+/// @brief Stops serving a client and unmaps its memfd once no worker is inside
+static void svc_drop(svc_t *d, svc_client_t *c)
+{
+  atomic_store(&c->active, 0);
+  while (atomic_load(&c->busy))
+    sched_yield();
+  svc_report(c, (uint32_t)(c - d->client));
+  munmap(c->ring, c->size);
+  close(c->memfd);
+  close(c->sock);
+  c->sock = -1;
+}
+
+/// @brief Parses "0,2,3" into cpus, or takes the first CPUs of the affinity mask
+static int svc_cpus(const char *list, int *cpus, int nb)
+{
+  cpu_set_t set;
+  int n = 0;
+
+  if (list)
+  {
+    for (const char *p = list; *p && n < nb; p += strcspn(p, ","), p += (*p == ','))
+      cpus[n++] = atoi(p);
+    return (n == nb) ? 0 : -1;
+  }
+  if (sched_getaffinity(0, sizeof(set), &set))
+    return -1;
+  for (int i = 0; n < nb; i = (i + 1) % CPU_SETSIZE)
+    if (CPU_ISSET(i, &set))
+      cpus[n++] = i;
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  static svc_t d;
+  struct sockaddr_un addr = {.sun_family = AF_UNIX};
+  int cpus[SVC_MAX_WORKERS], lsock;
+  char path[512];
+
+  if (argc < 2)
+  {
+    fprintf(stderr, "usage: %s <socket> [workers] [cpus] [chunk_re]\n", argv[0]);
+    return 1;
+  }
+  d.nb_workers = (argc > 2) ? atoi(argv[2]) : 1;
+  long chunk = (argc > 4) ? atol(argv[4]) : 0;
+  if (d.nb_workers < 1 || d.nb_workers > SVC_MAX_WORKERS || (argc > 4 && chunk < 8) ||
+      svc_cpus((argc > 3) ? argv[3] : NULL, cpus, d.nb_workers))
+  {
+    fprintf(stderr, "workers must be in [1, %d], one CPU per worker, chunk_re at least 8\n", SVC_MAX_WORKERS);
+    return 1;
+  }
+  for (int i = 0; i < SVC_MAX_CLIENTS; i++)
+    d.client[i].sock = -1;
+
+  // A whole request per claim would let one client hold a worker, hence the default when the tuner picked that
+  qam_tune_init(&d.tune, qam_tune_default_path(path, sizeof(path)));
+  for (int k = 0; k < 3; k++)
+  {
+    uint32_t c = chunk ? (uint32_t)chunk : qam_tune_cfg(&d.tune, 4 + 2 * k)->chunk_re;
+    d.chunk_re[k] = ((c ? c : SVC_CHUNK_RE) + 7) & ~7u;
+    qam_tune_print(&d.tune, 4 + 2 * k);
+  }
+
+  // Doorbell page, handed to every client
+  if ((d.bell_fd = memfd_create("qam-svcd-bell", MFD_CLOEXEC)) < 0 || ftruncate(d.bell_fd, 4096) ||
+      (d.bell = mmap(NULL, sizeof(qam_svc_bell_t), PROT_READ | PROT_WRITE, MAP_SHARED, d.bell_fd, 0)) == MAP_FAILED)
+  {
+    perror("qam-svcd: doorbell");
+    return 1;
+  }
+
+  strncpy(addr.sun_path, argv[1], sizeof(addr.sun_path) - 1);
+  unlink(addr.sun_path);
+  if ((lsock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0)) < 0 ||
+      bind(lsock, (struct sockaddr *)&addr, sizeof(addr)) || listen(lsock, SVC_MAX_CLIENTS))
+  {
+    perror("qam-svcd: socket");
+    return 1;
+  }
+
+  struct sigaction sa = {.sa_handler = on_signal}; // no SA_RESTART: poll() returns on the signal
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+
+  for (int i = 0; i < d.nb_workers; i++)
+  {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus[i], &set);
+    if (pthread_create(&d.worker[i], NULL, svc_worker, &d) ||
+        pthread_setaffinity_np(d.worker[i], sizeof(set), &set))
+    {
+      fprintf(stderr, "qam-svcd: cannot start worker %d on cpu %d\n", i, cpus[i]);
+      return 1;
+    }
+  }
+  printf("qam-svcd: %s, %d worker(s) on cpu", argv[1], d.nb_workers);
+  for (int i = 0; i < d.nb_workers; i++)
+    printf("%c%d", i ? ',' : ' ', cpus[i]);
+  printf(", %u/%u/%u-RE chunks for qm 4/6/8\n", d.chunk_re[0], d.chunk_re[1], d.chunk_re[2]);
+  fflush(stdout);
+
+  // Connections only: requests never go through the socket, a hang-up means the client is gone
+  while (!quit)
+  {
+    struct pollfd pfd[SVC_MAX_CLIENTS + 1];
+    svc_client_t *who[SVC_MAX_CLIENTS + 1];
+    int nfd = 0;
+
+    pfd[nfd].fd = lsock;
+    pfd[nfd++].events = POLLIN;
+    for (int i = 0; i < SVC_MAX_CLIENTS; i++)
+      if (d.client[i].sock >= 0)
+      {
+        who[nfd] = &d.client[i];
+        pfd[nfd].fd = d.client[i].sock;
+        pfd[nfd++].events = POLLIN;
+      }
+    if (poll(pfd, (nfds_t)nfd, -1) < 0)
+      continue;
+    for (int i = 1; i < nfd; i++)
+      if (pfd[i].revents)
+        svc_drop(&d, who[i]);
+    if (pfd[0].revents & POLLIN)
+    {
+      int sock = accept4(lsock, NULL, NULL, SOCK_CLOEXEC);
+      if (sock >= 0)
+        svc_accept(&d, sock);
+    }
+  }
+
+  atomic_store(&d.stop, 1);
+  atomic_fetch_add(&d.bell->seq, 1);
+  qam_svc_futex(&d.bell->seq, FUTEX_WAKE, INT_MAX);
+  for (int i = 0; i < d.nb_workers; i++)
+    pthread_join(d.worker[i], NULL);
+  const char *trace = getenv("QAM_TRACE_FILE");
+  if (trace && *trace)
+  {
+    long nb = qam_trace_export_chrome(trace);
+    if (nb < 0)
+      fprintf(stderr, "qam-svcd: cannot write %s\n", trace);
+    else
+      printf("qam-svcd: %ld trace events written to %s\n", nb, trace);
+  }
+  for (int i = 0; i < SVC_MAX_CLIENTS; i++)
+    if (d.client[i].sock >= 0)
+      svc_drop(&d, &d.client[i]);
+  close(lsock);
+  unlink(addr.sun_path);
+  return 0;
+}
@@ -0,0 +1,263 @@
+/// @brief Per-thread TSC trace rings for the demapper workers, exported as Chrome trace JSON
+///
+/// Every traced call records rdtsc at begin and end, the kernel, ISA, qm and RE count into the
+/// calling thread's ring. The owner thread is the only writer: an event is a plain store
+/// followed by a release store of the head, with no lock and no syscall. Old events are
+/// overwritten once the ring is full. The exporter may run while the workers keep tracing;
+/// it discards whatever was overwritten during the copy.
+///
+/// The workers of qam-sched.h, qam-rt.h and qam-svcd.c trace every LLR call they make. A ring
+/// outlives its thread so that the exporter still sees its events, and the next thread to
+/// register takes it over. Threads beyond QAM_TRACE_MAX_THREADS live ones are not traced.
+///
+/// The JSON opens in chrome://tracing and in the Perfetto UI (ui.perfetto.dev).
+/// Define QAM_TRACE_DISABLE to compile the tracing out.
+///
+
+#ifndef QAM_TRACE_H
+#define QAM_TRACE_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <x86intrin.h>
+
+#ifndef QAM_TRACE_RING_SIZE
+#define QAM_TRACE_RING_SIZE (1 << 16) // events per thread, power of 2
+#endif
+#define QAM_TRACE_MAX_THREADS 128
+
+typedef enum
+{
+  QAM_TRACE_LLR,
+  QAM_TRACE_NB_KERNELS,
+} qam_trace_kernel_t;
+
+typedef enum
+{
+  QAM_TRACE_SCALAR,
+  QAM_TRACE_SSE,
+  QAM_TRACE_AVX2,
+  QAM_TRACE_AVX512,
+  QAM_TRACE_NB_ISA,
+} qam_trace_isa_t;
+
+static const char *const qam_trace_kernel_name[QAM_TRACE_NB_KERNELS] = {
+    "llr",
+};
+static const char *const qam_trace_isa_name[QAM_TRACE_NB_ISA] = {"scalar", "sse", "avx2", "avx512"};
+
+typedef struct
+{
+  uint64_t begin; // TSC
+  uint64_t end;   // TSC
+  uint32_t nb_re;
+  uint8_t kernel; // qam_trace_kernel_t
+  uint8_t isa;    // qam_trace_isa_t
+  uint8_t qm;
+  uint8_t reserved;
+} qam_trace_event_t;
+
+typedef struct
+{
+  _Atomic uint64_t head; // events written so far
+  uint32_t tid;
+  _Atomic int owned; // 0 once the owner thread exited, the ring can be taken over
+  qam_trace_event_t ev[QAM_TRACE_RING_SIZE];
+} qam_trace_ring_t;
+
+static qam_trace_ring_t *qam_trace_rings[QAM_TRACE_MAX_THREADS];
+static _Atomic uint32_t qam_trace_nb_rings;
+static __thread qam_trace_ring_t *qam_trace_self;
+static __thread int qam_trace_untraced; // no ring could be had, do not try again
+static pthread_mutex_t qam_trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t qam_trace_key;
+static pthread_once_t qam_trace_once = PTHREAD_ONCE_INIT;
+static double qam_trace_tsc_per_us;
+
+/// @brief Thread exit: leaves the events in the ring and hands the ring to the next thread
+static inline void qam_trace_release(void *arg)
+{
+  qam_trace_ring_t *r = arg;
+  atomic_store_explicit(&r->owned, 0, memory_order_release);
+}
+
+static inline void qam_trace_key_init(void)
+{
+  pthread_key_create(&qam_trace_key, qam_trace_release);
+}
+
+/// @brief Ring of the calling thread, taken on its first traced call: a released one, else a new one
+static inline qam_trace_ring_t *qam_trace_ring(void)
+{
+  if (__builtin_expect(qam_trace_self != NULL, 1))
+    return qam_trace_self;
+  if (qam_trace_untraced)
+    return NULL;
+
+  qam_trace_ring_t *r = NULL;
+  pthread_once(&qam_trace_once, qam_trace_key_init);
+  pthread_mutex_lock(&qam_trace_lock);
+  uint32_t nb = atomic_load_explicit(&qam_trace_nb_rings, memory_order_relaxed);
+  for (uint32_t t = 0; t < nb && !r; t++)
+    if (!atomic_load_explicit(&qam_trace_rings[t]->owned, memory_order_acquire))
+      r = qam_trace_rings[t];
+  if (!r && nb < QAM_TRACE_MAX_THREADS && (r = calloc(1, sizeof(*r))))
+  {
+    // publish the pointer before the count so that the exporter never reads an empty slot
+    r->tid = nb;
+    qam_trace_rings[nb] = r;
+    atomic_store_explicit(&qam_trace_nb_rings, nb + 1, memory_order_release);
+  }
+  if (r)
+  {
+    atomic_store_explicit(&r->owned, 1, memory_order_relaxed);
+    pthread_setspecific(qam_trace_key, r);
+  }
+  pthread_mutex_unlock(&qam_trace_lock);
+
+  qam_trace_self = r;
+  qam_trace_untraced = !r;
+  return r;
+}
+
+static inline uint64_t qam_trace_begin(void)
+{
+  return __rdtsc();
+}
+
+/// @brief Records one call that ran from TSC begin to TSC end
+static inline void qam_trace_event(uint64_t begin, uint64_t end, qam_trace_kernel_t kernel, qam_trace_isa_t isa,
+                                   int qm, uint32_t nb_re)
+{
+  qam_trace_ring_t *r = qam_trace_ring();
+
+  if (!r)
+    return;
+  uint64_t h = atomic_load_explicit(&r->head, memory_order_relaxed);
+  qam_trace_event_t *e = &r->ev[h & (QAM_TRACE_RING_SIZE - 1)];
+  e->begin = begin;
+  e->end = end;
+  e->nb_re = nb_re;
+  e->kernel = (uint8_t)kernel;
+  e->isa = (uint8_t)isa;
+  e->qm = (uint8_t)qm;
+  atomic_store_explicit(&r->head, h + 1, memory_order_release);
+}
+
+/// @brief Records one call that started at TSC begin
+static inline void qam_trace_end(uint64_t begin, qam_trace_kernel_t kernel, qam_trace_isa_t isa, int qm, uint32_t nb_re)
+{
+  qam_trace_event(begin, __rdtsc(), kernel, isa, qm, nb_re);
+}
+
+#ifdef QAM_TRACE_DISABLE
+#define QAM_TRACE(kernel, isa, qm, nb_re, call) call
+#define QAM_TRACE_EVENT(begin, end, kernel, isa, qm, nb_re) ((void)0)
+#else
+/// @brief Records a call timed by the caller, for callers that read the TSC anyway
+#define QAM_TRACE_EVENT(begin, end, kernel, isa, qm, nb_re) qam_trace_event(begin, end, kernel, isa, qm, nb_re)
+/// @brief Runs call and traces it
+#define QAM_TRACE(kernel, isa, qm, nb_re, call)                                                                       \
+  do                                                                                                                   \
+  {                                                                                                                    \
+    uint64_t qam_trace_t0 = qam_trace_begin();                                                                        \
+    call;                                                                                                              \
+    qam_trace_end(qam_trace_t0, kernel, isa, qm, nb_re);                                                              \
+  } while (0)
+#endif
+
+/// @brief Measures the TSC rate against CLOCK_MONOTONIC over about 20 ms, once before exporting
+static inline double qam_trace_calibrate(void)
+{
+  struct timespec t0, t1;
+  uint64_t c0, c1;
+
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  c0 = __rdtsc();
+  do
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+  while ((t1.tv_sec - t0.tv_sec) * 1000000000LL + (t1.tv_nsec - t0.tv_nsec) < 20000000LL);
+  c1 = __rdtsc();
+  qam_trace_tsc_per_us = (double)(c1 - c0) / ((t1.tv_sec - t0.tv_sec) * 1e6 + (t1.tv_nsec - t0.tv_nsec) / 1e3);
+  return qam_trace_tsc_per_us;
+}
+
+/// @brief Copies the events of one ring still present after the copy, oldest first
+/// @return number of events copied to out (at most QAM_TRACE_RING_SIZE)
+static inline uint32_t qam_trace_snapshot(qam_trace_ring_t *r, qam_trace_event_t *out)
+{
+  uint64_t h0 = atomic_load_explicit(&r->head, memory_order_acquire);
+  uint64_t first = (h0 > QAM_TRACE_RING_SIZE) ? h0 - QAM_TRACE_RING_SIZE : 0;
+
+  for (uint64_t i = first; i < h0; i++)
+    out[i - first] = r->ev[i & (QAM_TRACE_RING_SIZE - 1)];
+  atomic_thread_fence(memory_order_acquire);
+
+  // the writer may have overwritten the oldest slots meanwhile, including the one it is writing now
+  uint64_t h1 = atomic_load_explicit(&r->head, memory_order_relaxed);
+  uint64_t valid = (h1 + 1 > QAM_TRACE_RING_SIZE) ? h1 + 1 - QAM_TRACE_RING_SIZE : 0;
+  if (valid <= first)
+    return (uint32_t)(h0 - first);
+  if (valid >= h0)
+    return 0;
+  memmove(out, &out[valid - first], (h0 - valid) * sizeof(*out));
+  return (uint32_t)(h0 - valid);
+}
+
+/// @brief Writes the events of every ring as Chrome trace JSON ("X" complete events, microseconds)
+/// @return number of events written, -1 on error
+static inline long qam_trace_export_chrome(const char *path)
+{
+  uint32_t nb_rings = atomic_load_explicit(&qam_trace_nb_rings, memory_order_acquire);
+  qam_trace_event_t *ev = malloc(QAM_TRACE_RING_SIZE * sizeof(*ev));
+  uint64_t origin = UINT64_MAX;
+  long nb = 0;
+  FILE *f;
+
+  if (!ev || !(f = fopen(path, "w")))
+  {
+    free(ev);
+    return -1;
+  }
+  if (qam_trace_tsc_per_us <= 0)
+    qam_trace_calibrate();
+
+  // common time origin: the oldest event still in any ring
+  for (uint32_t t = 0; t < nb_rings; t++)
+  {
+    uint32_t n = qam_trace_snapshot(qam_trace_rings[t], ev);
+    if (n && ev[0].begin < origin)
+      origin = ev[0].begin;
+  }
+
+  fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+  for (uint32_t t = 0; t < nb_rings; t++)
+  {
+    uint32_t n = qam_trace_snapshot(qam_trace_rings[t], ev);
+    fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"demapper %u\"}}",
+            (t || nb) ? ",\n" : "", qam_trace_rings[t]->tid, qam_trace_rings[t]->tid);
+    for (uint32_t i = 0; i < n; i++)
+    {
+      const qam_trace_event_t *e = &ev[i];
+      if (e->begin < origin)
+        continue;
+      fprintf(f,
+              ",\n{\"name\":\"%s %s\",\"cat\":\"qam\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,"
+              "\"args\":{\"qm\":%u,\"nb_re\":%u,\"isa\":\"%s\"}}",
+              qam_trace_kernel_name[e->kernel], qam_trace_isa_name[e->isa], qam_trace_rings[t]->tid,
+              (e->begin - origin) / qam_trace_tsc_per_us, (e->end - e->begin) / qam_trace_tsc_per_us, e->qm, e->nb_re,
+              qam_trace_isa_name[e->isa]);
+      nb++;
+    }
+  }
+  fprintf(f, "\n]}\n");
+  free(ev);
+  return (fclose(f) == 0) ? nb : -1;
+}
+
+#endif
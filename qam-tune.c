@@ -0,0 +1,62 @@
+/// @brief Autotuner tool: measures or shows the kernel configuration cached for this host
+///
+/// Usage: qam-tune [-f] [file]
+///   -f    measure again even if the cache matches this host
+///   file  cache file, default $QAM_TUNE_FILE, $XDG_CACHE_HOME/qam-tune or ~/.cache/qam-tune
+///
+/// qam-svcd reads the same cache at startup, so running this once per host spares it the
+/// measurement.
+///
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "qam-llr.h"
+#include "qam-tune.h"
+
+int main(int argc, char *argv[])
+{
+  static qam_tune_t tune;
+  char buf[512];
+  const char *path = NULL;
+  int force = 0, ret;
+
+  for (int i = 1; i < argc; i++)
+    if (!strcmp(argv[i], "-f"))
+      force = 1;
+    else if (!path && argv[i][0] != '-')
+      path = argv[i];
+    else
+    {
+      fprintf(stderr, "usage: %s [-f] [file]\n", argv[0]);
+      return 1;
+    }
+  if (!path && !(path = qam_tune_default_path(buf, sizeof(buf))))
+  {
+    fprintf(stderr, "no cache file: set QAM_TUNE_FILE or HOME\n");
+    return 1;
+  }
+
+  if (force)
+  {
+    memset(&tune, 0, sizeof(tune));
+    qam_tune_cpu(tune.cpu, sizeof(tune.cpu));
+    tune.isa_mask = qam_tune_isa_mask();
+    if ((ret = qam_tune_run(&tune) ? -1 : 0) == 0 && qam_tune_save(&tune, path))
+      fprintf(stderr, "cannot write %s\n", path);
+  }
+  else
+    ret = qam_tune_init(&tune, path);
+  if (ret < 0)
+  {
+    fprintf(stderr, "measurement failed\n");
+    return 1;
+  }
+
+  for (int qm = 4; qm <= 8; qm += 2)
+    qam_tune_print(&tune, qm);
+  printf("%s: %s\n", path, tune.cached ? "loaded" : "measured and saved");
+  return 0;
+}
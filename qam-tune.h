@@ -0,0 +1,361 @@
+/// @brief Startup autotuner: picks the ISA, store mode and chunk size of the LLR kernels per qm
+///
+/// Whether AVX-512 beats AVX2 depends on the frequency license and the permute cost of the
+/// host, and whether non-temporal stores or smaller chunks help depends on its cache sizes.
+/// qam_tune_run() therefore times every candidate on a slot-sized buffer: the kernel demaps one
+/// chunk, then a consumer standing in for the LDPC decoder reads that chunk back, as the
+/// scheduler (qam-sched.h) does with its chunk_re. Candidates run in interleaved rounds and
+/// keep their best round, so a frequency drift during tuning hits all of them alike.
+///
+/// The winners are cached in a small text file keyed by the CPU model and the ISAs compiled in.
+/// qam_tune_init() reuses it on later startups and only re-tunes when the key differs.
+///
+
+#ifndef QAM_TUNE_H
+#define QAM_TUNE_H
+
+#include <cpuid.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "qam-llr.h"
+
+#define QAM_TUNE_VERSION 1
+#ifndef QAM_TUNE_NB_RE
+#define QAM_TUNE_NB_RE (273 * QAM_NB_RE_PRB * 14) // one slot of 273 PRBs
+#endif
+#ifndef QAM_TUNE_ROUND_NS
+#define QAM_TUNE_ROUND_NS 2000000 // time per candidate and round
+#endif
+#define QAM_TUNE_ROUNDS 3
+#define QAM_TUNE_CHUNK_DEFAULT 1024
+
+typedef enum
+{
+  QAM_TUNE_SSE,
+  QAM_TUNE_AVX2,
+  QAM_TUNE_AVX512,
+  QAM_TUNE_NB_ISA,
+} qam_tune_isa_t;
+
+static const char *const qam_tune_isa_name[QAM_TUNE_NB_ISA] = {"sse", "avx2", "avx512"};
+static const uint32_t qam_tune_chunks[] = {256, 1024, 4096, 0}; // 0: the whole buffer at once
+
+typedef void (*qam_tune_fn)(int, const int16_t *, const int16_t *const *, uint32_t, int16_t *);
+
+/// @brief Kernel of each ISA, cached stores then non-temporal stores
+static const qam_tune_fn qam_tune_fns[QAM_TUNE_NB_ISA][2] = {
+    {qam_llr_sse, qam_llr_sse_nt},
+    {qam_llr_avx, qam_llr_avx_nt},
+#ifdef __AVX512BW__
+    {qam_llr_avx512, qam_llr_avx512_nt},
+#else
+    {NULL, NULL},
+#endif
+};
+
+/// @brief Winning configuration of one modulation order
+typedef struct
+{
+  uint8_t isa;       // qam_tune_isa_t
+  uint8_t nt;        // non-temporal stores
+  uint32_t chunk_re; // REs per kernel call, 0 for the whole buffer
+  double mre_s;      // throughput measured for it, MRE/s
+} qam_tune_cfg_t;
+
+typedef struct
+{
+  char cpu[96];           // CPU model key
+  unsigned isa_mask;      // candidate ISAs, bit per qam_tune_isa_t
+  int cached;             // loaded from the cache file rather than measured
+  qam_tune_cfg_t cfg[3];  // qm = 4, 6, 8
+} qam_tune_t;
+
+/// @brief ISAs both compiled in and supported by the host
+static inline unsigned qam_tune_isa_mask(void)
+{
+  unsigned m = 1u << QAM_TUNE_SSE;
+
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    m |= 1u << QAM_TUNE_AVX2;
+#ifdef __AVX512BW__
+  if (__builtin_cpu_supports("avx512bw"))
+    m |= 1u << QAM_TUNE_AVX512;
+#endif
+  return m;
+}
+
+/// @brief CPU brand string followed by family, model and stepping
+static inline void qam_tune_cpu(char *cpu, size_t len)
+{
+  unsigned r[12] = {0}, a, b, c, d;
+  char brand[49] = "unknown";
+
+  if (__get_cpuid(0x80000000, &a, &b, &c, &d) && a >= 0x80000004)
+  {
+    for (unsigned k = 0; k < 3; k++)
+      __get_cpuid(0x80000002 + k, &r[4 * k], &r[4 * k + 1], &r[4 * k + 2], &r[4 * k + 3]);
+    memcpy(brand, r, 48);
+    brand[48] = 0;
+  }
+  a = 0;
+  __get_cpuid(1, &a, &b, &c, &d);
+  unsigned family = ((a >> 8) & 15) + ((a >> 20) & 255), model = ((a >> 4) & 15) | ((a >> 12) & 0xf0);
+  char *s = brand;
+  while (*s == ' ')
+    s++;
+  snprintf(cpu, len, "%s (family %u model %u stepping %u)", s, family, model, a & 15);
+}
+
+/// @brief Cache file path: $QAM_TUNE_FILE, else $XDG_CACHE_HOME/qam-tune, else ~/.cache/qam-tune
+static inline const char *qam_tune_default_path(char *buf, size_t len)
+{
+  const char *env = getenv("QAM_TUNE_FILE"), *dir = getenv("XDG_CACHE_HOME"), *home = getenv("HOME");
+
+  if (env && *env)
+    return env;
+  if (dir && *dir)
+    snprintf(buf, len, "%s/qam-tune", dir);
+  else if (home && *home)
+  {
+    snprintf(buf, len, "%s/.cache", home);
+    if (mkdir(buf, 0755) && errno != EEXIST)
+      return NULL;
+    snprintf(buf, len, "%s/.cache/qam-tune", home);
+  }
+  else
+    return NULL;
+  return buf;
+}
+
+/// @brief Settings used when nothing could be measured: the widest ISA, cached stores
+static inline void qam_tune_defaults(qam_tune_t *t)
+{
+  for (int k = 0; k < 3; k++)
+  {
+    t->cfg[k].isa = (t->isa_mask >> QAM_TUNE_AVX2) & 1 ? QAM_TUNE_AVX2 : QAM_TUNE_SSE;
+    t->cfg[k].nt = 0;
+    t->cfg[k].chunk_re = QAM_TUNE_CHUNK_DEFAULT;
+    t->cfg[k].mre_s = 0;
+  }
+}
+
+static inline int64_t qam_tune_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/// @brief Demaps the buffer chunk by chunk, each chunk read back by the consumer
+/// @return sum of the LLRs, so that the reads are not optimized away
+static inline int64_t qam_tune_pass(qam_tune_fn fn, int qm, const int16_t *rxF, const int16_t *const *chmag,
+                                    uint32_t nb_re, uint32_t chunk_re, int16_t *llr)
+{
+  const int16_t *c[3];
+  int64_t sum = 0;
+
+  if (!chunk_re)
+    chunk_re = nb_re;
+  for (uint32_t re = 0; re < nb_re; re += chunk_re)
+  {
+    uint32_t n = (nb_re - re < chunk_re) ? nb_re - re : chunk_re;
+    for (int l = 0; l < QAM_NB_CHMAG(qm); l++)
+      c[l] = chmag[l] + 2 * re;
+    fn(qm, rxF + 2 * re, c, n, llr + (size_t)qm * re);
+    for (uint32_t i = 0; i < n * qm; i++)
+      sum += llr[(size_t)qm * re + i];
+  }
+  return sum;
+}
+
+/// @brief Times every candidate for qm = 4, 6 and 8 and keeps the fastest of each
+/// @return 0 on success, -1 if the buffers cannot be allocated (the defaults are kept)
+static inline int qam_tune_run(qam_tune_t *t)
+{
+  enum { NB_CHUNKS = sizeof(qam_tune_chunks) / sizeof(qam_tune_chunks[0]) };
+  const size_t n = 2 * (size_t)QAM_TUNE_NB_RE, sz = (n * sizeof(int16_t) + 63) & ~(size_t)63;
+  int16_t *rxF = aligned_alloc(64, sz), *llr = aligned_alloc(64, 4 * sz), *chmag[3];
+  int ok = rxF && llr;
+  volatile int64_t sink = 0;
+
+  for (int l = 0; l < 3; l++)
+    ok &= (chmag[l] = aligned_alloc(64, sz)) != NULL;
+  qam_tune_defaults(t);
+  if (!ok)
+    goto out;
+
+  // a 16-QAM to 256-QAM-like spread of amplitudes, the kernels are data independent anyway
+  uint32_t x = 1;
+  for (size_t i = 0; i < n; i++)
+  {
+    x = x * 1664525u + 1013904223u;
+    rxF[i] = (int16_t)((x >> 16) % 1024) - 512;
+    for (int l = 0; l < 3; l++)
+      chmag[l][i] = (int16_t)(256 >> l);
+  }
+
+  for (int k = 0; k < 3; k++)
+  {
+    int qm = 4 + 2 * k;
+    double best[QAM_TUNE_NB_ISA][2][NB_CHUNKS] = {{{0}}};
+
+    for (int round = 0; round < QAM_TUNE_ROUNDS; round++)
+      for (int isa = 0; isa < QAM_TUNE_NB_ISA; isa++)
+        for (int nt = 0; nt < 2 && ((t->isa_mask >> isa) & 1); nt++)
+          for (int ch = 0; ch < NB_CHUNKS; ch++)
+          {
+            qam_tune_fn fn = qam_tune_fns[isa][nt];
+            int64_t t0 = qam_tune_ns(), t1;
+            long reps = 0;
+            sink += qam_tune_pass(fn, qm, rxF, (const int16_t *const *)chmag, QAM_TUNE_NB_RE, qam_tune_chunks[ch], llr);
+            t0 = qam_tune_ns();
+            do
+            {
+              sink += qam_tune_pass(fn, qm, rxF, (const int16_t *const *)chmag, QAM_TUNE_NB_RE, qam_tune_chunks[ch],
+                                    llr);
+              reps++;
+            } while ((t1 = qam_tune_ns()) - t0 < QAM_TUNE_ROUND_NS);
+            double mre_s = (double)QAM_TUNE_NB_RE * reps * 1e3 / (double)(t1 - t0);
+            if (mre_s > best[isa][nt][ch])
+              best[isa][nt][ch] = mre_s;
+          }
+
+    for (int isa = 0; isa < QAM_TUNE_NB_ISA; isa++)
+      for (int nt = 0; nt < 2; nt++)
+        for (int ch = 0; ch < NB_CHUNKS; ch++)
+          if (best[isa][nt][ch] > t->cfg[k].mre_s)
+          {
+            t->cfg[k].isa = (uint8_t)isa;
+            t->cfg[k].nt = (uint8_t)nt;
+            t->cfg[k].chunk_re = qam_tune_chunks[ch];
+            t->cfg[k].mre_s = best[isa][nt][ch];
+          }
+  }
+
+out:
+  free(rxF);
+  free(llr);
+  for (int l = 0; l < 3; l++)
+    free(chmag[l]);
+  return ok ? 0 : -1;
+}
+
+/// @brief Writes the configuration to path
+/// @return 0 on success, -1 on error
+static inline int qam_tune_save(const qam_tune_t *t, const char *path)
+{
+  FILE *f = path ? fopen(path, "w") : NULL;
+
+  if (!f)
+    return -1;
+  fprintf(f, "qam-tune %d\ncpu %s\nisa %u\n", QAM_TUNE_VERSION, t->cpu, t->isa_mask);
+  for (int k = 0; k < 3; k++)
+    fprintf(f, "qm %d %s %s %u %.1f\n", 4 + 2 * k, qam_tune_isa_name[t->cfg[k].isa], t->cfg[k].nt ? "nt" : "cached",
+            t->cfg[k].chunk_re, t->cfg[k].mre_s);
+  return fclose(f) ? -1 : 0;
+}
+
+/// @brief Reads the configuration from path if it was written for this CPU and these ISAs
+/// @return 0 on success, -1 if the file is missing, malformed or keyed differently
+static inline int qam_tune_load(qam_tune_t *t, const char *path)
+{
+  FILE *f = path ? fopen(path, "r") : NULL;
+  char line[160], isa[16], store[16];
+  qam_tune_cfg_t cfg[3];
+  unsigned mask, chunk;
+  int version, qm, found = 0;
+
+  if (!f)
+    return -1;
+  if (!fgets(line, sizeof(line), f) || sscanf(line, "qam-tune %d", &version) != 1 || version != QAM_TUNE_VERSION ||
+      !fgets(line, sizeof(line), f) || strncmp(line, "cpu ", 4) || strcspn(line + 4, "\n") != strlen(t->cpu) ||
+      strncmp(line + 4, t->cpu, strlen(t->cpu)) || !fgets(line, sizeof(line), f) ||
+      sscanf(line, "isa %u", &mask) != 1 || mask != t->isa_mask)
+  {
+    fclose(f);
+    return -1;
+  }
+  while (fgets(line, sizeof(line), f))
+  {
+    double mre_s;
+    if (sscanf(line, "qm %d %15s %15s %u %lf", &qm, isa, store, &chunk, &mre_s) != 5 || (qm != 4 && qm != 6 && qm != 8))
+      continue;
+    qam_tune_cfg_t *c = &cfg[(qm - 4) / 2];
+    c->isa = QAM_TUNE_NB_ISA;
+    for (int i = 0; i < QAM_TUNE_NB_ISA; i++)
+      if (!strcmp(isa, qam_tune_isa_name[i]) && ((mask >> i) & 1))
+        c->isa = (uint8_t)i;
+    c->nt = !strcmp(store, "nt");
+    c->chunk_re = chunk;
+    c->mre_s = mre_s;
+    if (c->isa != QAM_TUNE_NB_ISA)
+      found |= 1 << ((qm - 4) / 2);
+  }
+  fclose(f);
+  if (found != 7)
+    return -1;
+  memcpy(t->cfg, cfg, sizeof(cfg));
+  return 0;
+}
+
+/// @brief Loads the configuration cached at path, or tunes and caches it
+/// @param path cache file, see qam_tune_default_path(); NULL tunes without caching
+/// @return 1 if loaded from the cache, 0 if measured, -1 if measuring failed and the defaults are used
+static inline int qam_tune_init(qam_tune_t *t, const char *path)
+{
+  memset(t, 0, sizeof(*t));
+  qam_tune_cpu(t->cpu, sizeof(t->cpu));
+  t->isa_mask = qam_tune_isa_mask();
+  if (qam_tune_load(t, path) == 0)
+    return t->cached = 1;
+  if (qam_tune_run(t))
+    return -1;
+  qam_tune_save(t, path);
+  return 0;
+}
+
+/// @brief Configuration chosen for qm = 4, 6 or 8
+static inline const qam_tune_cfg_t *qam_tune_cfg(const qam_tune_t *t, int qm)
+{
+  return &t->cfg[(qm - 4) / 2];
+}
+
+/// @brief LLRs of nb_re contiguous REs with the kernel and chunk size chosen for qm
+static inline void qam_tune_llr(const qam_tune_t *t, int qm, const int16_t *rxF, const int16_t *const *chmag,
+                                uint32_t nb_re, int16_t *llr)
+{
+  const qam_tune_cfg_t *c = qam_tune_cfg(t, qm);
+  uint32_t chunk_re = c->chunk_re ? c->chunk_re : nb_re;
+  const int16_t *ch[3];
+
+  for (uint32_t re = 0; re < nb_re; re += chunk_re)
+  {
+    uint32_t n = (nb_re - re < chunk_re) ? nb_re - re : chunk_re;
+    for (int l = 0; l < QAM_NB_CHMAG(qm); l++)
+      ch[l] = chmag[l] + 2 * re;
+    qam_tune_fns[c->isa][c->nt](qm, rxF + 2 * re, ch, n, llr + (size_t)qm * re);
+  }
+}
+
+/// @brief Prints the configuration chosen for qm
+static inline void qam_tune_print(const qam_tune_t *t, int qm)
+{
+  const qam_tune_cfg_t *c = qam_tune_cfg(t, qm);
+
+  printf("Autotuned for qm = %d on %s: %s, %s stores, ", qm, t->cpu, qam_tune_isa_name[c->isa],
+         c->nt ? "non-temporal" : "cached");
+  if (c->chunk_re)
+    printf("%u-RE chunks", c->chunk_re);
+  else
+    printf("whole buffer");
+  printf(", %.1f MRE/s%s\n", c->mre_s, t->cached ? " (cached)" : "");
+}
+
+#endif
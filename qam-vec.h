@@ -0,0 +1,118 @@
+/// @brief Golden test-vector format for the LLR kernels
+///
+/// A vector file is a 16-byte header followed by the payload, all little-endian:
+///   int16 rxF[2 * nb_re]                  compensated received symbols (I, Q)
+///   int16 chmag[QAM_NB_CHMAG(qm)][2 * nb_re]  channel magnitude levels
+///   int16 llr[qm * nb_re]                 expected LLRs
+///
+
+#ifndef QAM_VEC_H
+#define QAM_VEC_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "qam-llr.h"
+
+#define QAM_VEC_MAGIC "QLLR"
+#define QAM_VEC_VERSION 1
+
+/// @brief Header of a vector file
+typedef struct
+{
+  char magic[4];    // QAM_VEC_MAGIC
+  uint16_t version; // QAM_VEC_VERSION
+  uint8_t qm;       // modulation order: 4, 6 or 8
+  uint8_t reserved; // 0
+  uint32_t nb_re;   // number of REs
+  int32_t scale;    // int16 amplitude of the smallest constellation point, 0 if unknown
+} qam_vec_hdr_t;
+
+/// @brief Vector loaded in memory, buffers are 32-byte aligned
+typedef struct
+{
+  qam_vec_hdr_t hdr;
+  int16_t *rxF;
+  int16_t *chmag[3];
+  int16_t *llr;
+} qam_vec_t;
+
+/// @brief Allocates the buffers of a vector described by hdr
+static inline int qam_vec_alloc(qam_vec_t *v)
+{
+  size_t n = 2 * (size_t)v->hdr.nb_re;
+  size_t sz = ((n * sizeof(int16_t)) + 31) & ~(size_t)31;
+
+  memset(v->chmag, 0, sizeof(v->chmag));
+  v->rxF = aligned_alloc(32, sz ? sz : 32);
+  v->llr = aligned_alloc(32, (v->hdr.qm / 2) * sz + 32);
+  int ok = v->rxF && v->llr;
+  for (int l = 0; l < QAM_NB_CHMAG(v->hdr.qm); l++)
+    ok &= (v->chmag[l] = aligned_alloc(32, sz ? sz : 32)) != NULL;
+  return ok ? 0 : -1;
+}
+
+/// @brief Frees the buffers of a vector
+static inline void qam_vec_free(qam_vec_t *v)
+{
+  free(v->rxF);
+  free(v->llr);
+  for (int l = 0; l < 3; l++)
+    free(v->chmag[l]);
+  memset(v, 0, sizeof(*v));
+}
+
+/// @brief Reads a vector file
+/// @return 0 on success, -1 if the file cannot be read or is not a valid vector
+static inline int qam_vec_read(const char *path, qam_vec_t *v)
+{
+  FILE *f = fopen(path, "rb");
+  int ret = -1;
+
+  memset(v, 0, sizeof(*v));
+  if (!f)
+    return -1;
+  if (fread(&v->hdr, sizeof(v->hdr), 1, f) != 1 || memcmp(v->hdr.magic, QAM_VEC_MAGIC, 4) ||
+      v->hdr.version != QAM_VEC_VERSION || (v->hdr.qm != 4 && v->hdr.qm != 6 && v->hdr.qm != 8) ||
+      v->hdr.reserved || v->hdr.scale < 0 || v->hdr.scale > INT16_MAX)
+    goto out;
+  if (qam_vec_alloc(v))
+    goto out;
+
+  size_t n = 2 * (size_t)v->hdr.nb_re;
+  if (fread(v->rxF, sizeof(int16_t), n, f) != n)
+    goto out;
+  for (int l = 0; l < QAM_NB_CHMAG(v->hdr.qm); l++)
+    if (fread(v->chmag[l], sizeof(int16_t), n, f) != n)
+      goto out;
+  if (fread(v->llr, sizeof(int16_t), n * v->hdr.qm / 2, f) != n * v->hdr.qm / 2)
+    goto out;
+  ret = 0;
+
+out:
+  fclose(f);
+  if (ret)
+    qam_vec_free(v);
+  return ret;
+}
+
+/// @brief Writes a vector file
+/// @return 0 on success, -1 on I/O error
+static inline int qam_vec_write(const char *path, const qam_vec_t *v)
+{
+  FILE *f = fopen(path, "wb");
+  size_t n = 2 * (size_t)v->hdr.nb_re;
+  int ok;
+
+  if (!f)
+    return -1;
+  ok = fwrite(&v->hdr, sizeof(v->hdr), 1, f) == 1 && fwrite(v->rxF, sizeof(int16_t), n, f) == n;
+  for (int l = 0; ok && l < QAM_NB_CHMAG(v->hdr.qm); l++)
+    ok = fwrite(v->chmag[l], sizeof(int16_t), n, f) == n;
+  ok = ok && fwrite(v->llr, sizeof(int16_t), n * v->hdr.qm / 2, f) == n * v->hdr.qm / 2;
+  return (fclose(f) == 0 && ok) ? 0 : -1;
+}
+
+#endif
@@ -0,0 +1,92 @@
+/// @brief Computes Log-Likelihood Ratio (LLR) for QPSK
+///
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <tmmintrin.h> // SSSE3
+#include <emmintrin.h> // SSE2
+#include <smmintrin.h> // SSE4.1
+
+#include <immintrin.h> // AVX
+
+#include "qam-llr.h"
+
+int main()
+{
+  clock_t start, end;
+  double sse_cpu_time, avx_cpu_time;
+  // Transmitted bits, (b0, b1) on (I, Q)
+  const uint8_t bits[32] = {0, 1, 1, 1, 0, 0, 1, 0, 1, 1, 0, 0, 0, 1, 1, 0,
+                            0, 1, 1, 1, 0, 0, 1, 0, 1, 1, 0, 0, 0, 1, 1, 0};
+  // Compensated received symbol
+  int16_t rxFcomp[] __attribute__((aligned(32))) = {54, -33, -55, -52, 57, 51, -56, 42,
+                                                    -33, -57, 41, 48, 52, -34, -45, 55,
+                                                    46, -45, -34, -39, 47, 37, -46, 36,
+                                                    -56, -53, 48, 39, 41, -36, -44, 57};
+
+  // llr
+  int16_t llr_sse[32] = {[0 ... 31] = 0}, // for sse
+      llr_avx[32] = {[0 ... 31] = 0},     // for avx
+      llr_ref[32];
+
+  start = clock();
+  /// ------------------------------------- SSE -------------------------------------
+  printf("============================ SSE ===============================\n");
+  qpsk_llr_sse(rxFcomp, 16, llr_sse);
+  end = clock();
+  sse_cpu_time = ((double)(end - start)) / CLOCKS_PER_SEC;
+
+  start = clock();
+  /// ------------------------------------- AVX -------------------------------------
+  printf("============================ AVX ===============================\n");
+  qpsk_llr_avx(rxFcomp, 16, llr_avx);
+  end = clock();
+  avx_cpu_time = ((double)(end - start)) / CLOCKS_PER_SEC;
+  printf("CPU time duration for SSE = %E, and AVX256 = %E\n", sse_cpu_time, avx_cpu_time);
+
+  for (size_t i = 0; i < 16; i++)
+    printf("llr of symbol (%d, %d) = [%d, %d]\n", rxFcomp[2 * i], rxFcomp[2 * i + 1], llr_avx[2 * i], llr_avx[2 * i + 1]);
+
+  int s = 0, e = 0;
+  for (size_t i = 0; i < 32; i++)
+    (llr_sse[i] == llr_avx[i]) ? s++ : e++;
+
+  printf("Success = %d, Error = %d\n", s, e);
+
+  /// ------------------------------- Scalar reference -------------------------------
+  printf("=========================== Reference ==========================\n");
+  qpsk_llr_ref(rxFcomp, 16, llr_ref);
+
+  s = 0, e = 0;
+  for (size_t i = 0; i < 32; i++)
+    (llr_avx[i] == llr_ref[i]) ? s++ : e++;
+
+  printf("Reference: Success = %d, Error = %d\n", s, e);
+
+  /// ----------------------------------- Bits -----------------------------------
+  printf("============================= Bits =============================\n");
+  s = 0, e = 0;
+  for (size_t i = 0; i < 32; i++)
+    ((llr_avx[i] < 0) == bits[i]) ? s++ : e++;
+
+  printf("Bits: Success = %d, Error = %d\n", s, e);
+
+  /// ---------------------------------- Int8 input ----------------------------------
+  printf("============================= Int8 =============================\n");
+  int8_t rxF8[32], llr8_sse[32], llr8_avx[32];
+
+  qam_pack8_avx(rxFcomp, 0, 32, rxF8);
+  qpsk_llr8_sse(rxF8, 16, llr8_sse);
+  qpsk_llr8_avx(rxF8, 16, llr8_avx);
+
+  s = 0, e = 0;
+  for (size_t i = 0; i < 32; i++)
+    (llr8_sse[i] == llr_avx[i] && llr8_avx[i] == llr_avx[i]) ? s++ : e++;
+
+  printf("Int8: Success = %d, Error = %d\n", s, e);
+
+  return 0;
+}